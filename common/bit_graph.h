@@ -0,0 +1,157 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "graph_io.h"
+#include "memory_placement.h"
+
+inline int BitsetWords(int n)
+{
+    return (n + 63) / 64;
+}
+
+inline void SetBit(uint64_t* bs, int v)
+{
+    bs[v >> 6] |= (1ULL << (v & 63));
+}
+
+inline void ClearBit(uint64_t* bs, int v)
+{
+    bs[v >> 6] &= ~(1ULL << (v & 63));
+}
+
+inline bool TestBit(const uint64_t* bs, int v)
+{
+    return (bs[v >> 6] & (1ULL << (v & 63))) != 0ULL;
+}
+
+inline void OrEq(uint64_t* a, const uint64_t* b, int w)
+{
+    for (int i = 0; i < w; ++i) a[i] |= b[i];
+}
+
+inline bool IsEmpty(const uint64_t* a, int w)
+{
+    for (int i = 0; i < w; ++i)
+        if (a[i] != 0ULL) return false;
+    return true;
+}
+
+inline int PopCount(const uint64_t* a, int w)
+{
+    int count = 0;
+    for (int i = 0; i < w; ++i) count += std::popcount(a[i]);
+    return count;
+}
+
+inline int AndPopCount(const uint64_t* a, const uint64_t* b, int w)
+{
+    int count = 0;
+    for (int i = 0; i < w; ++i) count += std::popcount(a[i] & b[i]);
+    return count;
+}
+
+// calls f(v) for every set bit v in increasing order
+template <class F>
+inline void ForEachBit(const uint64_t* bs, int w, F&& f)
+{
+    for (int i = 0; i < w; ++i)
+    {
+        for (uint64_t word = bs[i]; word != 0ULL; word &= word - 1)
+            f(i * 64 + std::countr_zero(word));
+    }
+}
+
+// Dense adjacency matrix: one row of `words` 64-bit words per vertex, on huge pages once it
+// reaches 2 MB (see common/memory_placement.h).
+struct BitGraph
+{
+    int n = 0;
+    int words = 0;
+    std::vector<uint64_t, HugePageAllocator<uint64_t>> adj;
+
+    BitGraph() = default;
+
+    explicit BitGraph(int n)
+        : n(n), words(BitsetWords(n)), adj(static_cast<size_t>(n) * static_cast<size_t>(BitsetWords(n)), 0ULL)
+    {
+    }
+
+    explicit BitGraph(const CsrGraph& csr) : BitGraph(csr.n)
+    {
+        for (int v = 0; v < n; ++v)
+            for (int u : csr.Neighbours(v)) SetBit(Row(v), u);
+    }
+
+    inline const uint64_t* Row(int u) const
+    {
+        return adj.data() + static_cast<size_t>(u) * static_cast<size_t>(words);
+    }
+
+    inline uint64_t* Row(int u)
+    {
+        return adj.data() + static_cast<size_t>(u) * static_cast<size_t>(words);
+    }
+
+    inline bool IsAdjacent(int u, int v) const
+    {
+        return TestBit(Row(u), v);
+    }
+
+    void AddEdge(int u, int v)
+    {
+        SetBit(Row(u), v);
+        SetBit(Row(v), u);
+    }
+
+    // Row operations against bitsets of `words` words. ColoringEngine and the B&B use only
+    // these, so that HybridBitGraph (common/hybrid_bit_graph.h) can stand in for this class.
+
+    // bits |= row(v)
+    inline void OrRow(uint64_t* bits, int v) const
+    {
+        OrEq(bits, Row(v), words);
+    }
+
+    // bits &= ~row(v), from word `first_word` on
+    inline void AndNotRow(uint64_t* bits, int v, int first_word = 0) const
+    {
+        const uint64_t* row = Row(v);
+        for (int w = first_word; w < words; ++w) bits[w] &= ~row[w];
+    }
+
+    // bits &= row(v)
+    inline void AndRow(uint64_t* bits, int v) const
+    {
+        const uint64_t* row = Row(v);
+        for (int w = 0; w < words; ++w) bits[w] &= row[w];
+    }
+
+    // |row(v) & bits|
+    inline int RowAndPopCount(int v, const uint64_t* bits) const
+    {
+        return AndPopCount(Row(v), bits, words);
+    }
+
+    // f(u) for every neighbour u of v in bits, in increasing order
+    template <class F>
+    inline void ForEachNeighbourIn(int v, const uint64_t* bits, F&& f) const
+    {
+        const uint64_t* row = Row(v);
+        for (int w = 0; w < words; ++w)
+        {
+            for (uint64_t word = row[w] & bits[w]; word != 0ULL; word &= word - 1)
+                f(w * 64 + std::countr_zero(word));
+        }
+    }
+
+    // appends the neighbours of v among from[0..count) to `out`, keeping their order
+    inline void SelectAdjacent(int v, const std::vector<int>& from, int count, std::vector<int>& out) const
+    {
+        const uint64_t* row = Row(v);
+        for (int j = 0; j < count; ++j)
+            if (TestBit(row, from[j])) out.push_back(from[j]);
+    }
+};
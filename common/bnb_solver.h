@@ -0,0 +1,1191 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "bit_graph.h"
+#include "checkpoint.h"
+#include "coloring.h"
+#include "graph_io.h"
+#include "hybrid_bit_graph.h"
+#include "maxsat_bound.h"
+#include "memory_placement.h"
+#include "parallel.h"
+#include "random.h"
+#include "subproblem_cache.h"
+#include "symmetry.h"
+#include "tabu_search.h"
+#include "timing.h"
+#include "vertex_order.h"
+
+// Exact maximum (weight) clique search of lab4: branch and bound with coloring bounds over
+// bitset rows, parallel over the root branches, with checkpoints, clique enumeration and
+// the optional MaxSAT bounds, subproblem cache, orbit pruning and tabu hybrid set up below.
+// Rng: random engine of the greedy start, see Next32 in random.h for the requirements
+template <class Rng = Xoshiro256pp>
+class BnBSolver
+{
+public:
+    explicit BnBSolver(uint64_t seed = kDefaultSeed) : seed(seed), gen(DeriveSeed(seed, 0)) {}
+
+    // ordering: vertex ids are relabeled so that bitset rows of related vertices are close;
+    // cliques and weights are given in the file's ids at the interface
+    void ReadGraphFile(std::string filename, VertexOrdering ordering = VertexOrdering::None)
+    {
+        file = filename;
+        CsrGraph csr;
+        DimacsInfo info;
+        if (!ReadDimacsGraph(filename, csr, info))
+            return;
+        SetGraph(std::move(csr), ordering);
+    }
+
+    // A graph that is already in memory, instead of ReadGraphFile. A borrowed one
+    // (CsrGraph::Borrow) is read in place unless `ordering` relabels it into a copy.
+    // Weights and orbits of a previous graph are dropped.
+    void SetGraph(CsrGraph csr, VertexOrdering ordering = VertexOrdering::None)
+    {
+        relabeling = RelabelGraph(csr, ordering);
+        auto rows = std::make_shared<const HybridBitGraph>(csr, force_dense);
+        SetRows(std::move(csr), std::move(rows));
+    }
+
+    // The same with the rows of `csr` built beforehand (HybridBitGraph(csr, dense)) and shared
+    // with other solvers on the graph, so that each of them only copies the degrees. `csr` is
+    // not relabeled.
+    void SetGraph(CsrGraph csr, std::shared_ptr<const HybridBitGraph> rows)
+    {
+        relabeling = VertexRelabeling();
+        SetRows(std::move(csr), std::move(rows));
+    }
+
+    // Bound used by Expand: `shallow` while the current clique has fewer than `shallow_depth`
+    // vertices, `deep` below that. A tighter coloring near the root prunes whole subtrees,
+    // deeper down the cheap one wins on the number of nodes.
+    void SetColoring(ColoringStrategy shallow, int shallow_depth, ColoringStrategy deep)
+    {
+        shallow_coloring = shallow;
+        coloring_depth = shallow_depth;
+        deep_coloring = deep;
+    }
+
+    // Runs a tabu search thread next to the B&B workers. Every clique it improves on goes
+    // straight into the incumbent, so the bound prunes with it at once; in return the workers
+    // hand it the partial clique they are extending every kPollInterval nodes, which restarts
+    // the tabu search in the region the B&B still considers promising.
+    void EnableHybrid(bool enable)
+    {
+        hybrid = enable;
+    }
+
+    // Tightens the coloring bound by MaxSAT reasoning (common/maxsat_bound.h) at nodes whose
+    // bound is at most `margin` above what the incumbent needs; 0 turns it off. Only for the
+    // unweighted search without checkpoints: it reorders the branches of a node, so saved
+    // branch indices would no longer match.
+    void SetMaxSatMargin(int margin)
+    {
+        maxsat_margin = std::max(0, margin);
+    }
+
+    // Rows of the next ReadGraphFile or SetGraph: all dense bitsets, or compressed where that is at least
+    // 4x smaller (the default), see common/hybrid_bit_graph.h
+    void ForceDenseRows(bool dense)
+    {
+        force_dense = dense;
+    }
+
+    // adjacency rows kept as dense bitsets, and the bytes of all rows
+    int DenseRows() const
+    {
+        return graph->DenseRows();
+    }
+
+    size_t RowBytes() const
+    {
+        return graph->MemoryBytes();
+    }
+
+    // Pins worker threads to CPUs, spread over the NUMA nodes, and has a thread on each node
+    // other than the first copy the rows for the workers there, see common/memory_placement.h.
+    // Only with more than one worker.
+    void EnablePinning(bool enable)
+    {
+        pin_workers = enable;
+    }
+
+    // Keeps bounds of finished subproblems in a shared table of about `megabytes` (0: none),
+    // see common/subproblem_cache.h. Not used while enumerating, where finding a clique does
+    // not raise the incumbent.
+    void SetCacheSize(size_t megabytes)
+    {
+        cache = SubproblemCache(megabytes);
+    }
+
+    // Branches at the root only on one vertex per orbit of the automorphism group, see
+    // common/symmetry.h. Once the branch of a vertex is searched, every clique through a
+    // vertex of its orbit is an image of one already seen, so the orbit leaves the candidates
+    // of all later root branches and their subtrees. Not with checkpoints, whose saved branch
+    // indices assume the full root.
+    void EnableSymmetry(bool enable)
+    {
+        symmetry = enable;
+    }
+
+    // orbits found by the last RunBnB with symmetry enabled, 0 otherwise
+    int OrbitCount() const
+    {
+        return orbit_count;
+    }
+
+    // root branches skipped as images of earlier ones by the last search
+    int SkippedBranches() const
+    {
+        return skipped_branches;
+    }
+
+    // nodes expanded by the last search, over all workers
+    uint64_t Nodes() const
+    {
+        return searched_nodes.load();
+    }
+
+    struct CacheStats
+    {
+        uint64_t lookups = 0;
+        uint64_t hits = 0;    // a bound was found
+        uint64_t cutoffs = 0; // and pruned the node
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+    };
+
+    // of the last search, over all workers
+    CacheStats GetCacheStats() const
+    {
+        return cache_stats;
+    }
+
+    bool CacheEnabled() const
+    {
+        return cache.Enabled();
+    }
+
+    // The search stops `seconds` after this call (0: no limit) with the best clique so far,
+    // see TimedOut. With checkpoints enabled the frontier is saved first, so --resume can
+    // finish the proof later.
+    void SetTimeLimit(double seconds)
+    {
+        has_deadline = seconds > 0.0;
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        timed_out = false;
+    }
+
+    // Saves the search frontier to `path` every `interval_sec` seconds, on SIGINT/SIGTERM
+    // (the search then stops, see Interrupted) and once more when the search is complete.
+    void EnableCheckpoint(const std::string& path, double interval_sec)
+    {
+        checkpoint_path = path;
+        checkpoint_interval = interval_sec;
+        InstallInterruptHandler();
+    }
+
+    // Continues the search saved in `path`. Fails if the checkpoint was written for another
+    // graph, coloring or deterministic setting, since the saved frontier would not match.
+    bool LoadCheckpoint(const std::string& path, bool deterministic)
+    {
+        BinaryReader in;
+        char magic[8] = {};
+        uint64_t hash = 0, key = 0;
+        int32_t n = 0, shallow = 0, depth = 0, deep = 0, branches = 0, next_branch = 0;
+        uint8_t det = 0;
+        double seconds = 0.0;
+        std::vector<int32_t> clique;
+        uint64_t path_count = 0;
+        if (!in.Load(path))
+        {
+            std::cerr << "Error: Cannot open checkpoint '" << path << "'\n";
+            return false;
+        }
+        if (!in.Get(magic) || memcmp(magic, kCheckpointMagic, sizeof(magic)) != 0 || !in.Get(hash) ||
+            !in.Get(n) || !in.Get(shallow) || !in.Get(depth) || !in.Get(deep) || !in.Get(det) ||
+            !in.Get(branches) || !in.Get(next_branch) || !in.Get(seconds) || !in.Get(key) ||
+            !in.GetVector(clique) || !in.Get(path_count))
+        {
+            std::cerr << "Error: Checkpoint '" << path << "' is damaged\n";
+            return false;
+        }
+        if (hash != GraphHash() || n != graph->n || shallow != static_cast<int32_t>(shallow_coloring) ||
+            depth != coloring_depth || deep != static_cast<int32_t>(deep_coloring) || (det != 0) != deterministic)
+        {
+            std::cerr << "Error: Checkpoint '" << path << "' was saved for another graph or other search options\n";
+            return false;
+        }
+
+        std::vector<ResumePath> paths(static_cast<size_t>(std::min<uint64_t>(path_count, static_cast<uint64_t>(graph->n))));
+        for (uint64_t p = 0; p < path_count; ++p)
+        {
+            if (p >= paths.size() || !in.Get(paths[p].rank) || !in.GetVector(paths[p].indices) ||
+                paths[p].indices.empty())
+            {
+                std::cerr << "Error: Checkpoint '" << path << "' is damaged\n";
+                return false;
+            }
+        }
+
+        best_clique_vec.assign(clique.begin(), clique.end());
+        best_clique_set.clear();
+        for (int v : best_clique_vec) best_clique_set.insert(v);
+        best_key.store(key);
+        resume_paths = std::move(paths);
+        resume_next_branch = next_branch;
+        previous_seconds = seconds;
+        resumed = true;
+        return true;
+    }
+
+    // Switches to the maximum weight clique problem. Weights must be positive and their sum
+    // must fit in an int; otherwise returns false with the reason in `error`.
+    bool SetWeights(const std::vector<int64_t>& vertex_weights, std::string& error)
+    {
+        if (static_cast<int>(vertex_weights.size()) != graph->n)
+        {
+            error = "Expected one weight per vertex";
+            return false;
+        }
+        int64_t total = 0;
+        for (int64_t w : vertex_weights)
+        {
+            if (w <= 0)
+            {
+                error = "Vertex weights must be positive";
+                return false;
+            }
+            total += w;
+            if (total > std::numeric_limits<int32_t>::max())
+            {
+                error = "Total vertex weight does not fit in 32 bits";
+                return false;
+            }
+        }
+        const std::vector<int64_t> relabeled = relabeling.PermuteToRelabeled(vertex_weights);
+        weights.assign(relabeled.begin(), relabeled.end());
+        return true;
+    }
+
+    // threads: top-level branches are shared between this many worker threads
+    // deterministic: equally large cliques are ranked by the order in which the sequential
+    // search would reach them, so the result is the sequential one whatever the scheduling
+    void RunBnB(int threads = 1, bool deterministic = false)
+    {
+        // Fast initial lower bound
+        if (!resumed)
+            InitBestCliqueGreedy(8, 10);
+        if (symmetry && orbits.empty())
+        {
+            orbits = VertexOrbits(sorted_graph, weights);
+            orbit_count = 0;
+            for (int v = 0; v < graph->n; ++v) orbit_count += orbits[v] == v;
+        }
+
+        std::atomic<bool> tabu_stop{false};
+        std::thread tabu;
+        if (hybrid)
+            tabu = std::thread([&]() { RunTabu(tabu_stop, deterministic); });
+        ExpandRoot(RootCandidates(), std::max(1, threads), deterministic);
+        tabu_stop = true;
+        if (tabu.joinable())
+            tabu.join();
+    }
+
+    // Streams every maximum clique (k == 0) or the k largest maximal cliques (unweighted
+    // only) to `sink`, and returns how many were sent. RunBnB finds the optimum first; then
+    // every pass looks for the cliques of one exact target weight, pruning only nodes whose
+    // bound is below the target, so everything the sink receives is final and nothing is
+    // kept in memory. Each clique is reached by exactly one path of the branching, which
+    // makes the output free of duplicates.
+    int64_t Enumerate(int threads, bool deterministic, int64_t k, const std::function<void(const std::vector<int>&)>& sink)
+    {
+        RunBnB(threads, deterministic);
+        if (Interrupted() || TimedOut())
+            return 0;
+        const uint64_t optimum_key = best_key.load();
+        const int optimum = GetWeight();
+
+        int64_t found = 0;
+        for (int target = optimum; target >= 1; --target)
+        {
+            found += EnumeratePass(target, k == 0 ? 0 : k - found, k != 0, threads, deterministic, sink);
+            if (k == 0 || found >= k || TimedOut())
+                break;
+        }
+        best_key.store(optimum_key);
+        stop_requested = false;
+        return found;
+    }
+
+    // One answer of SolveSubsets, in the ids of the interface.
+    struct SubsetResult
+    {
+        size_t query = 0;        // index into the subsets
+        std::vector<int> clique; // sorted
+        int weight = 0;
+        bool optimal = true;     // false if the time limit cut the search short
+        uint64_t nodes = 0;
+    };
+
+    // Maximum (weight) clique of the subgraph induced by every vertex subset (ids of the
+    // interface; duplicates and ids out of range are dropped), on the rows of the loaded graph
+    // with its weights and colorings. A subset only becomes the candidate list of a root node,
+    // so nothing of the graph is copied, and the induced degrees that order it come from its
+    // bitset ANDed with the rows. Queries are shared between `threads` threads, each with an
+    // incumbent and a time limit of `seconds` (0: none) per query, and every answer goes to
+    // `sink` as soon as its search is done, one call at a time, in no particular order.
+    // Orbits, the cache and the hybrid thread are not used: they are set up for the whole graph.
+    void SolveSubsets(const std::vector<std::vector<int>>& subsets, int threads, double seconds,
+                      const std::function<void(const SubsetResult&)>& sink) const
+    {
+        threads = std::max(1, std::min(threads, static_cast<int>(subsets.size())));
+        std::vector<std::unique_ptr<BnBSolver>> solvers(threads);
+        std::vector<std::vector<uint64_t>> members(threads);
+        std::mutex sink_mutex;
+        ParallelFor(static_cast<int>(subsets.size()), threads, [&](int q, int thread_id)
+        {
+            if (!solvers[thread_id])
+            {
+                solvers[thread_id] = QuerySolver();
+                members[thread_id].assign(BitsetWords(graph->n), 0);
+            }
+            SubsetResult result = solvers[thread_id]->SolveSubset(subsets[q], seconds, members[thread_id]);
+            result.query = static_cast<size_t>(q);
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            sink(result);
+        });
+    }
+
+    std::vector<int> RootCandidates() const
+    {
+        std::vector<int> candidates(graph->n);
+        for (int i = 0; i < graph->n; ++i) candidates[i] = i;
+        std::sort(candidates.begin(), candidates.end(),
+                  [&](int a, int b) { return degree[a] > degree[b]; });
+        return candidates;
+    }
+
+    // true if the search stopped on a signal; the checkpoint then holds the rest of the work
+    bool Interrupted() const
+    {
+        return interrupted;
+    }
+
+    // true if the time limit ended the search, so the clique is not proven optimal
+    bool TimedOut() const
+    {
+        return timed_out.load();
+    }
+
+    // solve time of the runs before the resumed one
+    double PreviousSeconds() const
+    {
+        return previous_seconds;
+    }
+
+    std::unordered_set<int> GetClique()
+    {
+        std::unordered_set<int> result;
+        for (int v : best_clique_set) result.insert(relabeling.ToOriginal(v));
+        return result;
+    }
+
+    int VertexCount() const
+    {
+        return graph->n;
+    }
+
+    int GetWeight() const
+    {
+        return static_cast<int>(best_key.load() >> 32);
+    }
+
+    bool Check()
+    {
+        for (int i : best_clique_set)
+        {
+            for (int j : best_clique_set)
+            {
+                if (i != j && !graph->IsAdjacent(i, j))
+                {
+                    std::cout << "Returned subgraph is not clique\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ClearClique()
+    {
+        best_clique_set.clear();
+        best_clique_vec.clear();
+        best_key.store(0);
+    }
+
+private:
+    struct SearchState
+    {
+        explicit SearchState(const HybridBitGraph& rows) : rows(&rows), coloring(rows), maxsat(rows) {}
+
+        const HybridBitGraph* rows; // graph or its copy on the worker's NUMA node
+
+        std::vector<int> cur_clique;
+        int cur_weight = 0;
+        std::vector<int32_t> path; // loop index taken at every level, the top-level branch first
+        uint32_t rank = 0;    // sequential position of the top-level branch, 0 unless deterministic
+        uint64_t nodes = 0;   // for the periodic checks, see kPollInterval
+        BasicColoringEngine<HybridBitGraph> coloring;
+        BasicMaxSatBound<HybridBitGraph> maxsat;
+        CacheStats cache;
+        std::vector<uint64_t> common; // scratch of the maximality test
+    };
+
+    // A subproblem left unfinished by a checkpoint: the node reached by taking branch
+    // indices[d] at depth d. Nothing below that node was explored yet, and every branch
+    // before indices[d] at a level is done.
+    struct ResumePath
+    {
+        uint32_t rank = 0;
+        std::vector<int32_t> indices;
+    };
+
+    static constexpr char kCheckpointMagic[8] = {'B', 'N', 'B', 'C', 'K', 'P', 'T', '1'};
+    static constexpr uint64_t kPollInterval = 1024; // nodes between a worker's clock and seed checks
+    static constexpr size_t kCacheMinCandidates = 8; // smaller subproblems are cheaper to search
+    static constexpr int kTabuRandomization = 3;
+    static constexpr int kTabuPatience = 20000;
+    static constexpr int kTabuIdle = 7;
+
+    ColoringStrategy StrategyAt(int depth) const
+    {
+        return depth < coloring_depth ? shallow_coloring : deep_coloring;
+    }
+
+    // The incumbent is packed as (weight << 32) | ~rank, so a larger key is a better clique and
+    // among equal weights the clique of the earlier top-level branch wins. A node is pruned when
+    // the best key it can still reach is not larger than the incumbent one. Without vertex
+    // weights every vertex weighs 1 and the weight is the clique size.
+    static inline uint64_t PackKey(int weight, uint32_t rank)
+    {
+        return (static_cast<uint64_t>(weight) << 32) | static_cast<uint64_t>(~rank);
+    }
+
+    inline int Weight(int v) const
+    {
+        return weights.empty() ? 1 : weights[v];
+    }
+
+    int CliqueWeight(const std::vector<int>& clique) const
+    {
+        int total = 0;
+        for (int v : clique) total += Weight(v);
+        return total;
+    }
+
+    // Turns color classes into a weighted bound: each class contributes the largest weight
+    // in it. Sorting every class by increasing weight makes the bound of a prefix the sum of
+    // the earlier classes plus the weight of its last vertex, and still nondecreasing.
+    void WeightBounds(std::vector<int>& order, std::vector<int>& bounds) const
+    {
+        const int size = static_cast<int>(order.size());
+        int total = 0;
+        for (int begin = 0; begin < size;)
+        {
+            int end = begin;
+            while (end < size && bounds[end] == bounds[begin]) ++end;
+            std::stable_sort(order.begin() + begin, order.begin() + end,
+                             [&](int a, int b) { return weights[a] < weights[b]; });
+            for (int i = begin; i < end; ++i) bounds[i] = total + weights[order[i]];
+            total += weights[order[end - 1]];
+            begin = end;
+        }
+    }
+
+    void StoreBest(const std::vector<int>& clique, int weight, uint32_t rank)
+    {
+        const uint64_t key = PackKey(weight, rank);
+        if (key <= best_key.load(std::memory_order_relaxed))
+            return;
+        std::lock_guard<std::mutex> lock(best_mutex);
+        if (key <= best_key.load(std::memory_order_relaxed))
+            return;
+        best_clique_vec = clique;
+        best_clique_set.clear();
+        for (int v : best_clique_vec) best_clique_set.insert(v);
+        best_key.store(key, std::memory_order_relaxed);
+    }
+
+    // neighbours of order[i] among order[0..i-1]
+    void SelectNeighbours(const SearchState& state, const std::vector<int>& order, int i, std::vector<int>& new_candidates) const
+    {
+        new_candidates.clear();
+        new_candidates.reserve(static_cast<size_t>(i));
+        state.rows->SelectAdjacent(order[i], order, i, new_candidates);
+    }
+
+    // resume: the rest of a saved path; its first index is where the loop of this node starts
+    void Expand(SearchState& state, const std::vector<int>& candidates, std::span<const int32_t> resume = {})
+    {
+        if (resume.empty() && pause_requested.load(std::memory_order_relaxed))
+            Pause(&state);
+        if (stop_requested.load(std::memory_order_relaxed))
+            return;
+        if (++state.nodes % kPollInterval == 0)
+        {
+            if (hybrid)
+                tabu_seeds.Offer(state.cur_clique);
+            // with checkpoints the coordinator stops the search, after saving it
+            if (checkpoint_path.empty() && TimeUp())
+            {
+                timed_out = true;
+                stop_requested = true;
+            }
+        }
+
+        if (candidates.empty())
+        {
+            if (enum_sink != nullptr)
+                Emit(state);
+            else
+                StoreBest(state.cur_clique, state.cur_weight, state.rank);
+            return;
+        }
+
+        const bool cached = cache.Enabled() && enum_sink == nullptr && candidates.size() >= kCacheMinCandidates;
+        SetFingerprint print;
+        if (cached)
+        {
+            print = FingerprintSet(candidates);
+            ++state.cache.lookups;
+            int bound = 0;
+            if (cache.Lookup(print, bound))
+            {
+                ++state.cache.hits;
+                if (PackKey(state.cur_weight + bound, state.rank) <= best_key.load(std::memory_order_relaxed))
+                {
+                    ++state.cache.cutoffs;
+                    return;
+                }
+            }
+        }
+
+        const int cur_size = static_cast<int>(state.cur_clique.size());
+        std::vector<int> order;
+        std::vector<int> bounds;
+        state.coloring.Color(StrategyAt(cur_size), candidates, order, bounds);
+        if (!weights.empty())
+            WeightBounds(order, bounds);
+        else if (maxsat_margin > 0 && enum_sink == nullptr && checkpoint_path.empty())
+            RefineBounds(state, order, bounds);
+
+        int start = static_cast<int>(order.size()) - 1;
+        if (!resume.empty())
+            start = std::min(start, static_cast<int>(resume[0]));
+
+        std::vector<int> new_candidates;
+        for (int i = start; i >= 0; --i)
+        {
+            if (PackKey(state.cur_weight + bounds[i], state.rank) <= best_key.load(std::memory_order_relaxed))
+                break; // since bounds are nondecreasing for prefixes
+
+            const int v = order[i];
+            SelectNeighbours(state, order, i, new_candidates);
+
+            state.cur_clique.push_back(v);
+            state.cur_weight += Weight(v);
+            state.path.push_back(i);
+            Expand(state, new_candidates, i == start && !resume.empty() ? resume.subspan(1) : std::span<const int32_t>());
+            state.path.pop_back();
+            state.cur_weight -= Weight(v);
+            state.cur_clique.pop_back();
+            if (stop_requested.load(std::memory_order_relaxed))
+                return;
+        }
+
+        // A finished subtree found every clique that beats the incumbent, so none of the
+        // candidates' cliques beats it now. A resumed one was partly searched by another run.
+        if (cached && resume.empty())
+            StoreCacheBound(state, print);
+    }
+
+    void StoreCacheBound(SearchState& state, const SetFingerprint& print)
+    {
+        const uint64_t best = best_key.load(std::memory_order_relaxed);
+        const int best_weight = static_cast<int>(best >> 32);
+        int bound = best_weight - state.cur_weight;
+        if (PackKey(best_weight, state.rank) > best)
+            --bound;
+        if (bound < 1)
+            return;
+        ++state.cache.stores;
+        if (cache.Store(print, bound))
+            ++state.cache.evictions;
+    }
+
+    // Moves the branches that MaxSAT reasoning shows cannot beat the incumbent below the
+    // pruning point of the loop in Expand. Worth it only where the coloring bound is close.
+    void RefineBounds(SearchState& state, std::vector<int>& order, std::vector<int>& bounds)
+    {
+        if (bounds.empty())
+            return;
+        // kmin: the largest bound that Expand still prunes
+        const uint64_t best = best_key.load(std::memory_order_relaxed);
+        const int best_weight = static_cast<int>(best >> 32);
+        int kmin = best_weight - state.cur_weight;
+        if (PackKey(best_weight, state.rank) > best)
+            --kmin;
+        if (kmin > 0 && bounds.back() > kmin && bounds.back() - kmin <= maxsat_margin)
+            state.maxsat.Refine(order, bounds, kmin);
+    }
+
+    // Which root branches repeat an orbit already branched on, and from which branch on each
+    // vertex is dropped from the candidates: the one after its orbit's first branch. Fixed by
+    // the root order alone, so it holds however the workers interleave.
+    void PlanOrbitBranches(const std::vector<int>& order, std::vector<char>& skip, std::vector<int>& removed_from) const
+    {
+        const int branches = static_cast<int>(order.size());
+        std::vector<std::vector<int>> members(graph->n);
+        for (int v = 0; v < graph->n; ++v) members[orbits[v]].push_back(v);
+        skip.assign(branches, 0);
+        removed_from.assign(graph->n, branches);
+        std::vector<char> seen(graph->n, 0);
+        for (int k = 0; k < branches; ++k)
+        {
+            const int i = branches - 1 - k;
+            const int orbit = orbits[order[i]];
+            if (seen[orbit])
+            {
+                skip[i] = 1;
+                continue;
+            }
+            seen[orbit] = 1;
+            for (int v : members[orbit]) removed_from[v] = k + 1;
+        }
+    }
+
+    // The root loop of Expand with its branches claimed by worker threads in sequential order.
+    // Subproblems saved by a checkpoint come first, then the branches no one has started.
+    // A checkpoint pauses every worker at a node entry or between tasks, so the saved paths
+    // together with the claim counter describe all the remaining work exactly.
+    void ExpandRoot(const std::vector<int>& candidates, int threads, bool deterministic)
+    {
+        std::vector<int> order;
+        std::vector<int> bounds;
+        BasicColoringEngine<HybridBitGraph>(*graph).Color(StrategyAt(0), candidates, order, bounds);
+        if (!weights.empty())
+            WeightBounds(order, bounds);
+
+        const int branches = static_cast<int>(order.size());
+        std::vector<char> skip;
+        std::vector<int> removed_from;
+        if (!orbits.empty() && enum_sink == nullptr)
+        {
+            PlanOrbitBranches(order, skip, removed_from);
+            skipped_branches = static_cast<int>(std::count(skip.begin(), skip.end(), 1));
+        }
+        const int first_branch = std::min(resume_next_branch, branches);
+        const int resumed_tasks = static_cast<int>(resume_paths.size());
+        const int tasks = resumed_tasks + branches - first_branch;
+        int next_task = 0;
+        searched_nodes = 0;
+        cache_stats = CacheStats();
+        running_workers = threads;
+        paused_workers = 0;
+        pause_requested = false;
+        stop_requested = false;
+        interrupted = false;
+
+        const bool pin = pin_workers && threads > 1;
+        if (pin)
+            ReplicateRows();
+        auto worker = [&](int worker_id)
+        {
+            if (pin)
+                PinCurrentThread(placement.CpuOf(worker_id));
+            SearchState state(pin ? RowsOfNode(placement.NodeOf(worker_id)) : *graph);
+            std::vector<int> new_candidates;
+            while (true)
+            {
+                int t;
+                {
+                    std::unique_lock<std::mutex> lock(pause_mutex);
+                    while (pause_requested && !stop_requested) WaitWhilePaused(lock, nullptr);
+                    t = stop_requested ? tasks : next_task++;
+                    if (t >= tasks)
+                    {
+                        searched_nodes += state.nodes;
+                        cache_stats.lookups += state.cache.lookups;
+                        cache_stats.hits += state.cache.hits;
+                        cache_stats.cutoffs += state.cache.cutoffs;
+                        cache_stats.stores += state.cache.stores;
+                        cache_stats.evictions += state.cache.evictions;
+                        --running_workers;
+                        pause_cv.notify_all();
+                        return;
+                    }
+                }
+
+                std::span<const int32_t> resume;
+                int i;
+                if (t < resumed_tasks)
+                {
+                    state.rank = resume_paths[t].rank;
+                    resume = resume_paths[t].indices;
+                    i = std::min(static_cast<int>(resume[0]), branches - 1);
+                    resume = resume.subspan(1);
+                }
+                else
+                {
+                    const int k = first_branch + t - resumed_tasks;
+                    i = branches - 1 - k;
+                    state.rank = deterministic ? static_cast<uint32_t>(k + 1) : 0;
+                }
+                if (PackKey(bounds[i], state.rank) <= best_key.load(std::memory_order_relaxed))
+                    continue; // later branches have smaller bounds and later ranks
+                if (!skip.empty() && skip[i])
+                    continue;
+
+                SelectNeighbours(state, order, i, new_candidates);
+                if (!removed_from.empty())
+                {
+                    const int k = branches - 1 - i;
+                    erase_if(new_candidates, [&](int u) { return removed_from[u] <= k; });
+                }
+                state.cur_clique.assign(1, order[i]);
+                state.cur_weight = Weight(order[i]);
+                state.path.assign(1, i);
+                Expand(state, new_candidates, resume);
+            }
+        };
+
+        // Remaining work as seen by a paused search: the paths the workers stopped at,
+        // resumed paths nobody took yet, and the top-level branches after the claimed ones.
+        auto save = [&](bool complete)
+        {
+            const int claimed = complete ? tasks : next_task;
+            std::vector<ResumePath> paths;
+            if (!complete)
+                paths = paused_paths;
+            for (int t = claimed; t < resumed_tasks; ++t) paths.push_back(resume_paths[t]);
+            const int next_branch = first_branch + std::max(0, claimed - resumed_tasks);
+            const double seconds = previous_seconds + run_watch.Seconds();
+            if (!SaveCheckpoint(paths, branches, next_branch, deterministic, seconds))
+                std::cerr << "Error: Cannot write checkpoint '" << checkpoint_path << "'\n";
+        };
+
+        run_watch.Restart();
+        std::thread coordinator;
+        bool search_done = false;
+        if (!checkpoint_path.empty())
+        {
+            coordinator = std::thread([&]()
+            {
+                auto last = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> lock(pause_mutex);
+                while (!search_done)
+                {
+                    pause_cv.wait_for(lock, std::chrono::milliseconds(100));
+                    const bool interrupt = InterruptRequested();
+                    const bool out_of_time = TimeUp();
+                    const bool due = std::chrono::steady_clock::now() - last >= std::chrono::duration<double>(checkpoint_interval);
+                    if (search_done || (!interrupt && !out_of_time && !due))
+                        continue;
+
+                    paused_paths.clear();
+                    pause_requested = true;
+                    pause_cv.wait(lock, [&]() { return paused_workers == running_workers; });
+                    save(false);
+                    last = std::chrono::steady_clock::now();
+                    if (interrupt || out_of_time)
+                    {
+                        interrupted = interrupt;
+                        timed_out = !interrupt;
+                        stop_requested = true;
+                    }
+                    pause_requested = false;
+                    pause_cv.notify_all();
+                    pause_cv.wait(lock, [&]() { return paused_workers == 0; });
+                    if (interrupt || out_of_time)
+                        return;
+                }
+            });
+        }
+
+        if (threads == 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) workers.emplace_back(worker, t);
+            for (std::thread& w : workers) w.join();
+        }
+
+        if (coordinator.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(pause_mutex);
+                search_done = true;
+            }
+            pause_cv.notify_all();
+            coordinator.join();
+            if (!interrupted && !timed_out)
+                save(true);
+        }
+        resume_paths.clear(); // a later search starts from scratch
+        resume_next_branch = 0;
+    }
+
+    // One enumeration pass: the incumbent is set just below `target`, so that only nodes
+    // that cannot reach the target weight are pruned, and leaves of that weight are emitted.
+    // limit: stop after this many cliques, 0 for no limit
+    // maximal_only: skip cliques that some vertex outside them could extend
+    int64_t EnumeratePass(int target, int64_t limit, bool maximal_only, int threads, bool deterministic,
+                          const std::function<void(const std::vector<int>&)>& sink)
+    {
+        enum_sink = &sink;
+        enum_target = target;
+        enum_limit = limit;
+        enum_maximal_only = maximal_only;
+        enum_found = 0;
+        best_key.store(PackKey(target - 1, 0));
+        ExpandRoot(RootCandidates(), std::max(1, threads), deterministic);
+        enum_sink = nullptr;
+        return enum_found;
+    }
+
+    void Emit(SearchState& state)
+    {
+        if (state.cur_weight != enum_target)
+            return;
+        if (enum_maximal_only && !IsMaximal(state))
+            return;
+        std::lock_guard<std::mutex> lock(best_mutex);
+        if (enum_limit > 0 && enum_found >= enum_limit)
+            return;
+        (*enum_sink)(relabeling.ToOriginal(state.cur_clique));
+        if (++enum_found == enum_limit)
+            stop_requested = true;
+    }
+
+    // no vertex is adjacent to the whole clique
+    bool IsMaximal(SearchState& state) const
+    {
+        const HybridBitGraph& rows = *state.rows;
+        state.common.assign(rows.words, 0ULL);
+        rows.OrRow(state.common.data(), state.cur_clique[0]);
+        for (size_t j = 1; j < state.cur_clique.size(); ++j) rows.AndRow(state.common.data(), state.cur_clique[j]);
+        return IsEmpty(state.common.data(), rows.words);
+    }
+
+    // One copy of the rows per NUMA node after the first, each made by a thread on that node so
+    // that first touch puts its pages there. Kept until the next graph is read.
+    void ReplicateRows()
+    {
+        const int nodes = placement.NodeCount();
+        if (static_cast<int>(node_rows.size()) == nodes - 1)
+            return;
+        node_rows.assign(nodes - 1, HybridBitGraph());
+        std::vector<std::thread> copiers;
+        for (int node = 1; node < nodes; ++node)
+        {
+            copiers.emplace_back([&, node]()
+            {
+                PinCurrentThread(placement.CpuOfNode(node));
+                node_rows[node - 1] = *graph;
+            });
+        }
+        for (std::thread& c : copiers) c.join();
+    }
+
+    const HybridBitGraph& RowsOfNode(int node) const
+    {
+        return node == 0 ? *graph : node_rows[node - 1];
+    }
+
+    bool TimeUp() const
+    {
+        return has_deadline && std::chrono::steady_clock::now() >= deadline;
+    }
+
+    // Called with pause_mutex held. Records where the worker stands (nullptr: between tasks)
+    // and sleeps until the checkpoint is written.
+    void WaitWhilePaused(std::unique_lock<std::mutex>& lock, const SearchState* state)
+    {
+        if (state != nullptr)
+            paused_paths.push_back({state->rank, state->path});
+        ++paused_workers;
+        pause_cv.notify_all();
+        pause_cv.wait(lock, [&]() { return !pause_requested.load(); });
+        --paused_workers;
+        pause_cv.notify_all();
+    }
+
+    void Pause(const SearchState* state)
+    {
+        std::unique_lock<std::mutex> lock(pause_mutex);
+        if (pause_requested)
+            WaitWhilePaused(lock, state);
+    }
+
+    uint64_t GraphHash() const
+    {
+        const uint64_t hash = graph->Hash();
+        if (weights.empty())
+            return hash;
+        std::vector<uint64_t> w(weights.begin(), weights.end());
+        return hash ^ HashWords(w.data(), w.size());
+    }
+
+    // Layout: magic, graph hash, n, coloring (shallow, depth, deep), deterministic flag,
+    // top-level branch count and the next unclaimed one, solve seconds so far, incumbent key
+    // and clique, then the unfinished paths as (rank, indices).
+    bool SaveCheckpoint(const std::vector<ResumePath>& paths, int branches, int next_branch, bool deterministic,
+                        double seconds) const
+    {
+        BinaryWriter out;
+        out.Put(kCheckpointMagic);
+        out.Put(GraphHash());
+        out.Put(static_cast<int32_t>(graph->n));
+        out.Put(static_cast<int32_t>(shallow_coloring));
+        out.Put(static_cast<int32_t>(coloring_depth));
+        out.Put(static_cast<int32_t>(deep_coloring));
+        out.Put(static_cast<uint8_t>(deterministic ? 1 : 0));
+        out.Put(static_cast<int32_t>(branches));
+        out.Put(static_cast<int32_t>(next_branch));
+        out.Put(seconds);
+        {
+            std::lock_guard<std::mutex> lock(best_mutex);
+            out.Put(best_key.load());
+            out.PutVector(std::vector<int32_t>(best_clique_vec.begin(), best_clique_vec.end()));
+        }
+        out.Put(static_cast<uint64_t>(paths.size()));
+        for (const ResumePath& path : paths)
+        {
+            out.Put(path.rank);
+            out.PutVector(path.indices);
+        }
+        return out.Commit(checkpoint_path);
+    }
+
+    // The tabu thread of the hybrid mode, until `stop`. It works in bursts that end after
+    // kTabuPatience steps without a better clique, and idles kTabuIdle times as long as the
+    // burst took before the next one, which starts from the latest B&B seed. So it takes
+    // a small share of the CPU once it stops finding anything, even when the B&B workers
+    // use every core. In deterministic mode its cliques get the last rank, so a B&B clique
+    // of the same weight still replaces them and the result stays the sequential one.
+    void RunTabu(const std::atomic<bool>& stop, bool deterministic)
+    {
+        const uint32_t rank = deterministic ? std::numeric_limits<uint32_t>::max() : 0;
+        MaxCliqueTabuSearch<Rng> tabu(seed);
+        tabu.SetGraph(sorted_graph);
+        tabu.Connect([&](const std::vector<int>& clique) { StoreBest(clique, CliqueWeight(clique), rank); },
+                     &stop, &tabu_seeds, kTabuPatience);
+        for (uint64_t burst = 1; !stop.load(); ++burst)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            tabu.SetSeed(DeriveSeed(seed, burst));
+            tabu.RunSearch(std::numeric_limits<int>::max() / 4, kTabuRandomization);
+            const auto idle_until = std::chrono::steady_clock::now() + (std::chrono::steady_clock::now() - start) * kTabuIdle;
+            while (!stop.load() && std::chrono::steady_clock::now() < idle_until)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+private:
+    // a solver for one thread of SolveSubsets: the same rows, weights and search settings,
+    // its own incumbent and time limit
+    std::unique_ptr<BnBSolver> QuerySolver() const
+    {
+        auto solver = std::make_unique<BnBSolver>(seed);
+        solver->graph = graph;
+        solver->relabeling = relabeling;
+        solver->degree = degree;
+        solver->weights = weights;
+        solver->shallow_coloring = shallow_coloring;
+        solver->coloring_depth = coloring_depth;
+        solver->deep_coloring = deep_coloring;
+        solver->maxsat_margin = maxsat_margin;
+        return solver;
+    }
+
+    // `members`: all-zero scratch of graph->n bits, left all zero
+    SubsetResult SolveSubset(const std::vector<int>& subset, double seconds, std::vector<uint64_t>& members)
+    {
+        std::vector<int> candidates;
+        candidates.reserve(subset.size());
+        for (int v : subset)
+        {
+            if (v < 0 || v >= graph->n)
+                continue;
+            const int u = relabeling.ToRelabeled(v);
+            if (!TestBit(members.data(), u))
+                candidates.push_back(u);
+            SetBit(members.data(), u);
+        }
+        // by decreasing degree within the subset, as RootCandidates orders the whole graph
+        std::vector<int> induced(candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i) induced[i] = graph->RowAndPopCount(candidates[i], members.data());
+        std::vector<int> by_degree(candidates.size());
+        for (size_t i = 0; i < by_degree.size(); ++i) by_degree[i] = static_cast<int>(i);
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b) { return induced[a] > induced[b]; });
+        for (int& i : by_degree) i = candidates[i];
+        for (int u : candidates) ClearBit(members.data(), u);
+
+        ClearClique();
+        SetTimeLimit(seconds);
+        stop_requested = false;
+        SearchState state(*graph);
+        Expand(state, by_degree);
+
+        SubsetResult result;
+        result.clique = relabeling.ToOriginal(best_clique_vec);
+        std::sort(result.clique.begin(), result.clique.end());
+        result.weight = GetWeight();
+        result.optimal = !TimedOut();
+        result.nodes = state.nodes;
+        return result;
+    }
+
+    void SetRows(CsrGraph csr, std::shared_ptr<const HybridBitGraph> rows)
+    {
+        graph = std::move(rows);
+        node_rows.clear();
+        degree.assign(graph->n, 0);
+        for (int v = 0; v < graph->n; ++v) degree[v] = csr.Degree(v);
+        sorted_graph = std::move(csr);
+        weights.clear();
+        orbits.clear();
+        orbit_count = 0;
+    }
+
+    void InitBestCliqueGreedy(int starts, int rcl)
+    {
+        const int n = graph->n;
+        if (n <= 0) return;
+        if (starts <= 0) starts = 1;
+        if (rcl <= 0) rcl = 1;
+
+        std::vector<int> base(n);
+        for (int i = 0; i < n; ++i) base[i] = i;
+        std::sort(base.begin(), base.end(), [&](int a, int b) { return degree[a] > degree[b]; });
+
+        for (int s = 0; s < starts; ++s)
+        {
+            std::vector<int> cand = base;
+            std::vector<int> clique;
+            clique.reserve(64);
+
+            while (!cand.empty())
+            {
+                const int last = static_cast<int>(cand.size()) - 1;
+                const int take = std::min(rcl - 1, last);
+                const int pick_idx = UniformInt(gen, 0, take);
+                const int v = cand[pick_idx];
+
+                clique.push_back(v);
+
+                std::vector<int> next;
+                next.reserve(static_cast<size_t>(last));
+                for (int i = 0; i < static_cast<int>(cand.size()); ++i)
+                {
+                    if (i == pick_idx) continue;
+                    const int u = cand[i];
+                    if (graph->IsAdjacent(v, u)) next.push_back(u);
+                }
+                cand.swap(next);
+            }
+
+            StoreBest(clique, CliqueWeight(clique), 0);
+        }
+    }
+
+    std::shared_ptr<const HybridBitGraph> graph = std::make_shared<const HybridBitGraph>();
+    bool force_dense = false; // see ForceDenseRows
+    // NUMA placement, see EnablePinning
+    bool pin_workers = false;
+    WorkerPlacement placement;
+    std::vector<HybridBitGraph> node_rows; // copies of graph for nodes 1.., see ReplicateRows
+    CsrGraph sorted_graph; // the same graph as sorted lists, for the tabu thread
+    VertexRelabeling relabeling;
+    std::vector<int> degree;
+    std::vector<int> weights; // empty for the unweighted problem
+    ColoringStrategy shallow_coloring = ColoringStrategy::SequentialGreedy;
+    int coloring_depth = 0;
+    ColoringStrategy deep_coloring = ColoringStrategy::SequentialGreedy;
+
+    uint64_t seed;
+    Rng gen;
+    std::atomic<uint64_t> best_key{0};
+    mutable std::mutex best_mutex;
+    std::vector<int> best_clique_vec;
+    std::unordered_set<int> best_clique_set;
+
+    std::string file;
+
+    // time limit, see SetTimeLimit
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> timed_out{false};
+
+    // hybrid mode, see EnableHybrid
+    bool hybrid = false;
+    int maxsat_margin = 0; // see SetMaxSatMargin
+    std::atomic<uint64_t> searched_nodes{0};
+    // symmetry, see EnableSymmetry
+    bool symmetry = false;
+    std::vector<int> orbits; // smallest vertex of the orbit of every vertex, empty when off
+    int orbit_count = 0;
+    int skipped_branches = 0;
+    SubproblemCache cache;    // see SetCacheSize
+    CacheStats cache_stats;   // added up by the exiting workers under pause_mutex
+    CliqueSeedBox tabu_seeds;
+
+    // checkpointing
+    std::string checkpoint_path;
+    double checkpoint_interval = 60.0;
+    Stopwatch run_watch;
+    double previous_seconds = 0.0;
+    bool resumed = false;
+    bool interrupted = false;
+    std::vector<ResumePath> resume_paths;
+    int resume_next_branch = 0;
+
+    // enumeration passes, see EnumeratePass
+    const std::function<void(const std::vector<int>&)>* enum_sink = nullptr;
+    int enum_target = 0;
+    int64_t enum_limit = 0;
+    bool enum_maximal_only = false;
+    int64_t enum_found = 0;
+
+    // workers stop at the next node entry while a checkpoint is taken
+    std::atomic<bool> pause_requested{false};
+    std::atomic<bool> stop_requested{false};
+    std::mutex pause_mutex;
+    std::condition_variable pause_cv;
+    int running_workers = 0;
+    int paused_workers = 0;
+    std::vector<ResumePath> paused_paths;
+};
@@ -0,0 +1,27 @@
+# Compile definitions that identify a build in the results log (common/results_log.h):
+# CLIQUE_GIT_HASH, the commit it was configured at ("-dirty" with local changes), and
+# CLIQUE_BUILD_FLAGS, the compiler and its flags. A commit or checkout reconfigures the
+# project; edits to the working tree alone do not.
+function(add_build_info target)
+    execute_process(COMMAND git describe --always --dirty --abbrev=12
+                    WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+                    OUTPUT_VARIABLE git_hash
+                    OUTPUT_STRIP_TRAILING_WHITESPACE
+                    ERROR_QUIET)
+    execute_process(COMMAND git rev-parse --absolute-git-dir
+                    WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+                    OUTPUT_VARIABLE git_dir
+                    OUTPUT_STRIP_TRAILING_WHITESPACE
+                    ERROR_QUIET)
+    if(NOT git_hash)
+        set(git_hash "unknown")
+    endif()
+    if(git_dir AND EXISTS "${git_dir}/logs/HEAD")
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${git_dir}/logs/HEAD")
+    endif()
+
+    string(TOUPPER "${CMAKE_BUILD_TYPE}" build_type)
+    string(STRIP "${CMAKE_CXX_COMPILER_ID} ${CMAKE_CXX_COMPILER_VERSION} ${CMAKE_BUILD_TYPE} ${CMAKE_CXX_FLAGS} ${CMAKE_CXX_FLAGS_${build_type}}" flags)
+    string(REGEX REPLACE " +" " " flags "${flags}")
+    target_compile_definitions(${target} PRIVATE CLIQUE_GIT_HASH="${git_hash}" CLIQUE_BUILD_FLAGS="${flags}")
+endfunction()
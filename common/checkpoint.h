@@ -0,0 +1,129 @@
+#pragma once
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Buffered writer for binary checkpoint files. Values are stored in host byte order: a
+// checkpoint is meant to be resumed by the same build on the same kind of machine.
+class BinaryWriter
+{
+public:
+    template <class T>
+    void Put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.append(bytes, sizeof(T));
+    }
+
+    template <class T>
+    void PutVector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Put(static_cast<uint64_t>(values.size()));
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    // Writes to `path`.tmp and renames it over `path`, so a crash while saving leaves the
+    // previous checkpoint intact.
+    bool Commit(const std::string& path) const
+    {
+        const std::string tmp = path + ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.close(); // a failed flush must not replace the good checkpoint
+        if (!out)
+        {
+            std::remove(tmp.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        std::remove(path.c_str()); // rename does not replace an existing file on Windows
+#endif
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    std::string buffer;
+};
+
+class BinaryReader
+{
+public:
+    bool Load(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        pos = 0;
+        return true;
+    }
+
+    template <class T>
+    bool Get(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (buffer.size() - pos < sizeof(T))
+            return false;
+        std::memcpy(&value, buffer.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    template <class T>
+    bool GetVector(std::vector<T>& values)
+    {
+        uint64_t size = 0;
+        if (!Get(size) || size > (buffer.size() - pos) / sizeof(T))
+            return false;
+        values.resize(static_cast<size_t>(size));
+        std::memcpy(values.data(), buffer.data() + pos, static_cast<size_t>(size) * sizeof(T));
+        pos += static_cast<size_t>(size) * sizeof(T);
+        return true;
+    }
+
+    bool AtEnd() const
+    {
+        return pos == buffer.size();
+    }
+
+private:
+    std::string buffer;
+    size_t pos = 0;
+};
+
+// Fingerprint of a word array, used to refuse checkpoints written for another graph.
+inline uint64_t HashWords(const uint64_t* data, size_t count)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        h ^= data[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h *= 0xBF58476D1CE4E5B9ULL;
+    }
+    return h;
+}
+
+// SIGINT/SIGTERM only set a flag, so that a long search can save a checkpoint and stop
+// cleanly instead of losing its progress.
+inline volatile std::sig_atomic_t g_interrupt_requested = 0;
+
+inline void InstallInterruptHandler()
+{
+    auto handler = [](int) { g_interrupt_requested = 1; };
+    std::signal(SIGINT, handler);
+    std::signal(SIGTERM, handler);
+}
+
+inline bool InterruptRequested()
+{
+    return g_interrupt_requested != 0;
+}
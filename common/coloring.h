@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bit_graph.h"
+
+enum class ColoringStrategy
+{
+    SequentialGreedy, // first fit in the given vertex order
+    BitsetGreedy,     // classes grown by word-parallel bitset scans, in vertex id order
+    Dsatur,           // most saturated vertex first (Brelaz)
+    Rlf,              // recursive largest first (Leighton)
+};
+
+constexpr ColoringStrategy kAllColoringStrategies[] = {
+    ColoringStrategy::SequentialGreedy, ColoringStrategy::BitsetGreedy,
+    ColoringStrategy::Dsatur, ColoringStrategy::Rlf,
+};
+
+inline const char* ColoringStrategyName(ColoringStrategy strategy)
+{
+    switch (strategy)
+    {
+    case ColoringStrategy::SequentialGreedy: return "greedy";
+    case ColoringStrategy::BitsetGreedy: return "bitset-greedy";
+    case ColoringStrategy::Dsatur: return "dsatur";
+    case ColoringStrategy::Rlf: return "rlf";
+    }
+    return "?";
+}
+
+inline bool ParseColoringStrategy(const std::string& name, ColoringStrategy& strategy)
+{
+    for (ColoringStrategy s : kAllColoringStrategies)
+    {
+        if (name == ColoringStrategyName(s))
+        {
+            strategy = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Colors vertex subsets of a BitGraph. The result lists the vertices grouped by color class,
+// classes in increasing color, with bounds[i] the (1-based) color of order[i]. So bounds is
+// nondecreasing and bounds[i] bounds the clique number of order[0..i], which is what
+// branch and bound needs. One engine per thread: it keeps scratch buffers between calls.
+// Graph is BitGraph or anything with its row operations, such as HybridBitGraph.
+template <class Graph>
+class BasicColoringEngine
+{
+public:
+    explicit BasicColoringEngine(const Graph& graph)
+        : graph(&graph), subset_bits(graph.words), work_bits(graph.words), extra_bits(graph.words),
+          local_index(graph.n, -1)
+    {
+    }
+
+    // `vertices` in the order the greedy strategies visit them; returns the number of colors
+    int Color(ColoringStrategy strategy, const std::vector<int>& vertices, std::vector<int>& order,
+              std::vector<int>& bounds)
+    {
+        order.clear();
+        bounds.clear();
+        if (strategy == ColoringStrategy::SequentialGreedy)
+            return SequentialGreedy(vertices, order, bounds);
+
+        std::fill(subset_bits.begin(), subset_bits.end(), 0ULL);
+        for (int v : vertices) SetBit(subset_bits.data(), v);
+        if (strategy == ColoringStrategy::Dsatur)
+            return Dsatur(vertices, order, bounds);
+        return ColorBits(strategy, order, bounds);
+    }
+
+    // the subset as a bitset of graph.words words, visited in vertex id order
+    int Color(ColoringStrategy strategy, const uint64_t* subset, std::vector<int>& order,
+              std::vector<int>& bounds)
+    {
+        order.clear();
+        bounds.clear();
+        std::copy(subset, subset + graph->words, subset_bits.begin());
+        if (strategy == ColoringStrategy::SequentialGreedy || strategy == ColoringStrategy::Dsatur)
+        {
+            list.clear();
+            ForEachBit(subset, graph->words, [&](int v) { list.push_back(v); });
+            const std::vector<int> vertices = list;
+            return strategy == ColoringStrategy::Dsatur ? Dsatur(vertices, order, bounds)
+                                                        : SequentialGreedy(vertices, order, bounds);
+        }
+        return ColorBits(strategy, order, bounds);
+    }
+
+private:
+    int ColorBits(ColoringStrategy strategy, std::vector<int>& order, std::vector<int>& bounds)
+    {
+        return strategy == ColoringStrategy::Rlf ? Rlf(order, bounds) : BitsetGreedy(order, bounds);
+    }
+
+    // one pass per color over the still uncolored vertices, taking each one that is not
+    // adjacent to the class built so far
+    int SequentialGreedy(const std::vector<int>& vertices, std::vector<int>& order, std::vector<int>& bounds)
+    {
+        list = vertices;
+        next_list.clear();
+        int color = 0;
+        while (!list.empty())
+        {
+            ++color;
+            std::fill(work_bits.begin(), work_bits.end(), 0ULL);
+            next_list.clear();
+            for (int v : list)
+            {
+                if (!TestBit(work_bits.data(), v))
+                {
+                    order.push_back(v);
+                    bounds.push_back(color);
+                    SetBit(work_bits.data(), v);
+                    graph->OrRow(work_bits.data(), v);
+                }
+                else
+                {
+                    next_list.push_back(v);
+                }
+            }
+            list.swap(next_list);
+        }
+        return color;
+    }
+
+    // Same classes as the sequential greedy over vertex id order, but each class is found
+    // by repeatedly taking the lowest candidate bit and masking out its neighbourhood.
+    int BitsetGreedy(std::vector<int>& order, std::vector<int>& bounds)
+    {
+        const int words = graph->words;
+        uint64_t* uncolored = subset_bits.data();
+        uint64_t* candidates = work_bits.data();
+        int first_word = 0;
+        int color = 0;
+        while (true)
+        {
+            while (first_word < words && uncolored[first_word] == 0ULL) ++first_word;
+            if (first_word == words)
+                break;
+            ++color;
+            std::copy(uncolored + first_word, uncolored + words, candidates + first_word);
+            for (int w = first_word; w < words; ++w)
+            {
+                while (candidates[w] != 0ULL)
+                {
+                    const int v = w * 64 + std::countr_zero(candidates[w]);
+                    order.push_back(v);
+                    bounds.push_back(color);
+                    ClearBit(uncolored, v);
+                    candidates[w] &= candidates[w] - 1;
+                    graph->AndNotRow(candidates, v, w);
+                }
+            }
+        }
+        return color;
+    }
+
+    int Dsatur(const std::vector<int>& vertices, std::vector<int>& order, std::vector<int>& bounds)
+    {
+        const int s = static_cast<int>(vertices.size());
+        if (s == 0)
+            return 0;
+        const int color_words = BitsetWords(s + 1);
+        for (int i = 0; i < s; ++i) local_index[vertices[i]] = i;
+
+        degree.assign(s, 0);
+        saturation.assign(s, 0);
+        color_of.assign(s, 0);
+        neighbour_colors.assign(static_cast<size_t>(s) * color_words, 0ULL);
+        for (int i = 0; i < s; ++i)
+            degree[i] = graph->RowAndPopCount(vertices[i], subset_bits.data());
+
+        int colors = 0;
+        for (int step = 0; step < s; ++step)
+        {
+            int best = -1;
+            for (int i = 0; i < s; ++i)
+            {
+                if (color_of[i] != 0)
+                    continue;
+                if (best == -1 || saturation[i] > saturation[best] ||
+                    (saturation[i] == saturation[best] && degree[i] > degree[best]))
+                    best = i;
+            }
+
+            // smallest color not used by a neighbour
+            const uint64_t* used = neighbour_colors.data() + static_cast<size_t>(best) * color_words;
+            int color = 1;
+            while (TestBit(used, color)) ++color;
+            color_of[best] = color;
+            colors = std::max(colors, color);
+
+            graph->ForEachNeighbourIn(vertices[best], subset_bits.data(), [&](int u)
+            {
+                const int j = local_index[u];
+                uint64_t* seen = neighbour_colors.data() + static_cast<size_t>(j) * color_words;
+                if (color_of[j] == 0 && !TestBit(seen, color))
+                {
+                    SetBit(seen, color);
+                    ++saturation[j];
+                }
+            });
+        }
+
+        // counting sort by color keeps the given order inside every class
+        class_start.assign(colors + 2, 0);
+        for (int i = 0; i < s; ++i) ++class_start[color_of[i] + 1];
+        for (int c = 1; c <= colors + 1; ++c) class_start[c] += class_start[c - 1];
+        order.resize(s);
+        bounds.resize(s);
+        for (int i = 0; i < s; ++i)
+        {
+            const int pos = class_start[color_of[i]]++;
+            order[pos] = vertices[i];
+            bounds[pos] = color_of[i];
+        }
+        for (int v : vertices) local_index[v] = -1;
+        return colors;
+    }
+
+    // Builds one class at a time: start from the uncolored vertex of largest degree, then
+    // keep adding the candidate with most neighbours among the vertices already excluded
+    // from the class, so that the remaining graph loses as many edges as possible.
+    int Rlf(std::vector<int>& order, std::vector<int>& bounds)
+    {
+        const int words = graph->words;
+        uint64_t* uncolored = subset_bits.data();
+        uint64_t* candidates = work_bits.data();
+        uint64_t* excluded = extra_bits.data();
+        int color = 0;
+        while (!IsEmpty(uncolored, words))
+        {
+            ++color;
+            std::copy(uncolored, uncolored + words, candidates);
+            std::fill(excluded, excluded + words, 0ULL);
+
+            int v = -1;
+            int best_degree = -1;
+            ForEachBit(candidates, words, [&](int u)
+            {
+                const int d = graph->RowAndPopCount(u, uncolored);
+                if (d > best_degree)
+                {
+                    best_degree = d;
+                    v = u;
+                }
+            });
+
+            while (v != -1)
+            {
+                order.push_back(v);
+                bounds.push_back(color);
+                ClearBit(uncolored, v);
+                ClearBit(candidates, v);
+                graph->ForEachNeighbourIn(v, candidates, [&](int u) { SetBit(excluded, u); });
+                graph->AndNotRow(candidates, v);
+
+                v = -1;
+                int best_excluded = -1;
+                int best_remaining = 0;
+                ForEachBit(candidates, words, [&](int u)
+                {
+                    const int e = graph->RowAndPopCount(u, excluded);
+                    if (e < best_excluded)
+                        return;
+                    const int r = graph->RowAndPopCount(u, candidates);
+                    if (e > best_excluded || r < best_remaining)
+                    {
+                        best_excluded = e;
+                        best_remaining = r;
+                        v = u;
+                    }
+                });
+            }
+        }
+        return color;
+    }
+
+    const Graph* graph;
+    std::vector<uint64_t> subset_bits;
+    std::vector<uint64_t> work_bits;
+    std::vector<uint64_t> extra_bits;
+    std::vector<int> list;
+    std::vector<int> next_list;
+
+    // DSATUR state, indexed by position in the vertex list
+    std::vector<int> local_index; // vertex -> position, -1 outside the subset
+    std::vector<int> degree;
+    std::vector<int> saturation;
+    std::vector<int> color_of;
+    std::vector<uint64_t> neighbour_colors;
+    std::vector<int> class_start;
+};
+
+using ColoringEngine = BasicColoringEngine<BitGraph>;
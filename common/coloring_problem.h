@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "bit_graph.h"
+#include "coloring.h"
+#include "graph_io.h"
+#include "random.h"
+
+// Graph coloring of week1: DSATUR with ties broken by degree, uncolored neighbours and their
+// degrees, and a color choice that keeps neighbour saturation low (GreedyGraphColoring), or
+// any strategy of the shared ColoringEngine (ColorWith). Colors are 1-based.
+class ColoringProblem
+{
+public:
+    explicit ColoringProblem(uint64_t seed = kDefaultSeed) : generator(static_cast<uint32_t>(DeriveSeed(seed, 0))) {}
+
+    int GetRandom(int a, int b)
+    {
+        std::uniform_int_distribution<int> uniform(a, b);
+        return uniform(generator);
+    }
+
+    void ReadGraphFile(std::string filename)
+    {
+        DimacsInfo info;
+        ReadDimacsGraph(filename, graph, info);
+        colors.assign(graph.n, 0);
+        bit_graph = BitGraph();
+    }
+
+    // a graph that is already in memory, instead of ReadGraphFile; a borrowed one
+    // (CsrGraph::Borrow) is read in place
+    void SetGraph(CsrGraph csr)
+    {
+        graph = std::move(csr);
+        colors.assign(graph.n, 0);
+        bit_graph = BitGraph();
+    }
+
+    void GreedyGraphColoring()
+    {
+        const int n = graph.n;
+        colors.assign(n, 0);
+        maxcolor = 1;
+        
+        std::vector<int> saturation(n, 0);
+        std::vector<bool> used_colors;
+        used_colors.reserve(n + 1);
+        
+        std::unordered_set<int> uncolored_vertices;
+        for (int i = 0; i < n; ++i)
+            uncolored_vertices.insert(i);
+
+        while (!uncolored_vertices.empty())
+        {
+            // Select vertex with highest saturation degree
+            int max_saturation = -1;
+            int max_degree = -1;
+            int max_uncolored_neighbors = -1;
+            long long max_neighbor_degree_sum = -1;
+            std::vector<int> candidate_list;
+
+            for (int vertex : uncolored_vertices)
+            {
+                int sat = saturation[vertex];
+                int degree = graph.Degree(vertex);
+                
+                int uncolored_neighbors = 0;
+                long long neighbor_degree_sum = 0;
+                for (int neighbour : graph.Neighbours(vertex))
+                {
+                    if (colors[neighbour] == 0)
+                    {
+                        uncolored_neighbors++;
+                        neighbor_degree_sum += graph.Degree(neighbour);
+                    }
+                }
+
+                if (sat > max_saturation)
+                {
+                    max_saturation = sat;
+                    max_degree = degree;
+                    max_uncolored_neighbors = uncolored_neighbors;
+                    max_neighbor_degree_sum = neighbor_degree_sum;
+                    candidate_list.clear();
+                    candidate_list.push_back(vertex);
+                }
+                else if (sat == max_saturation)
+                {
+                    if (degree > max_degree)
+                    {
+                        max_degree = degree;
+                        max_uncolored_neighbors = uncolored_neighbors;
+                        max_neighbor_degree_sum = neighbor_degree_sum;
+                        candidate_list.clear();
+                        candidate_list.push_back(vertex);
+                    }
+                    else if (degree == max_degree)
+                    {
+                        if (uncolored_neighbors > max_uncolored_neighbors)
+                        {
+                            max_uncolored_neighbors = uncolored_neighbors;
+                            max_neighbor_degree_sum = neighbor_degree_sum;
+                            candidate_list.clear();
+                            candidate_list.push_back(vertex);
+                        }
+                        else if (uncolored_neighbors == max_uncolored_neighbors)
+                        {
+                            if (neighbor_degree_sum > max_neighbor_degree_sum)
+                            {
+                                max_neighbor_degree_sum = neighbor_degree_sum;
+                                candidate_list.clear();
+                                candidate_list.push_back(vertex);
+                            }
+                            else if (neighbor_degree_sum == max_neighbor_degree_sum)
+                            {
+                                candidate_list.push_back(vertex);
+                            }
+                        }
+                    }
+                }
+            }
+
+            int vertex = candidate_list[0];
+            
+            // Find the smallest available color
+            used_colors.assign(maxcolor + 2, false);
+            for (int neighbour : graph.Neighbours(vertex))
+            {
+                if (colors[neighbour] != 0)
+                {
+                    used_colors[colors[neighbour]] = true;
+                }
+            }
+            
+            // prefer colors that dont increase neighbor saturation
+            // among those, prefer largest existing color
+            int best_color = 1;
+            int min_saturation_increase = INT_MAX;
+            bool found_zero_increase = false;
+            
+            for (int color = 1; color <= maxcolor; ++color)
+            {
+                if (used_colors[color])
+                    continue;
+                
+                int saturation_increase = 0;
+                for (int neighbour : graph.Neighbours(vertex))
+                {
+                    if (colors[neighbour] == 0)
+                    {
+                        bool has_color = false;
+                        for (int other_neighbour : graph.Neighbours(neighbour))
+                        {
+                            if (colors[other_neighbour] == color)
+                            {
+                                has_color = true;
+                                break;
+                            }
+                        }
+                        if (!has_color)
+                            saturation_increase++;
+                    }
+                }
+                
+                if (saturation_increase == 0)
+                {
+                    if (!found_zero_increase || color > best_color)
+                    {
+                        found_zero_increase = true;
+                        best_color = color;
+                        min_saturation_increase = 0;
+                    }
+                }
+                else if (!found_zero_increase)
+                {
+                    if (saturation_increase < min_saturation_increase)
+                    {
+                        min_saturation_increase = saturation_increase;
+                        best_color = color;
+                    }
+                    else if (saturation_increase == min_saturation_increase && color > best_color)
+                    {
+                        // Among colors with same saturation increase, prefer larger (better balance)
+                        best_color = color;
+                    }
+                }
+            }
+            
+            if (!found_zero_increase && min_saturation_increase == INT_MAX)
+            {
+                best_color = maxcolor + 1;
+                maxcolor = best_color;
+            }
+
+            colors[vertex] = best_color;
+
+            // faster than recalculating for all uncolored vertices
+            for (int neighbour : graph.Neighbours(vertex))
+            {
+                if (colors[neighbour] == 0)
+                {
+                    std::unordered_set<int> neighbor_colors;
+                    for (int other_neighbour : graph.Neighbours(neighbour))
+                    {
+                        if (colors[other_neighbour] != 0)
+                        {
+                            neighbor_colors.insert(colors[other_neighbour]);
+                        }
+                    }
+                    saturation[neighbour] = static_cast<int>(neighbor_colors.size());
+                }
+            }
+
+            uncolored_vertices.erase(vertex);
+        }
+    }
+
+    // Colors the graph with one of the shared engine strategies, visiting vertices by
+    // decreasing degree. The bitset adjacency is built once, outside of the timed part.
+    void ColorWith(ColoringStrategy strategy)
+    {
+        if (bit_graph.n != graph.n)
+            PrepareBitGraph();
+
+        std::vector<int> vertices(graph.n);
+        for (int i = 0; i < graph.n; ++i) vertices[i] = i;
+        std::stable_sort(vertices.begin(), vertices.end(),
+                    [&](int a, int b) { return graph.Degree(a) > graph.Degree(b); });
+
+        std::vector<int> order, bounds;
+        ColoringEngine engine(bit_graph);
+        maxcolor = engine.Color(strategy, vertices, order, bounds);
+        colors.assign(graph.n, 0);
+        for (size_t i = 0; i < order.size(); ++i) colors[order[i]] = bounds[i];
+    }
+
+    void PrepareBitGraph()
+    {
+        bit_graph = BitGraph(graph);
+    }
+
+    bool Check()
+    {
+        for (int i = 0; i < graph.n; ++i)
+        {
+            if (colors[i] == 0)
+            {
+                std::cout << "Vertex " << i + 1 << " is not colored\n";
+                return false;
+            }
+            for (int neighbour : graph.Neighbours(i))
+            {
+                if (colors[neighbour] == colors[i])
+                {
+                    std::cout << "Neighbour vertices " << i + 1 << ", " << neighbour + 1 <<  " have the same color\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    int GetNumberOfColors()
+    {
+        return maxcolor;
+    }
+
+    const std::vector<int>& GetColors()
+    {
+        return colors;
+    }
+
+private:
+    std::mt19937 generator;
+    std::vector<int> colors;
+    int maxcolor = 1;
+    CsrGraph graph;
+    BitGraph bit_graph;
+};
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "graph_io.h"
+#include "random.h"
+
+// Synthetic graphs for benchmarks beyond the fixed DIMACS set. Every generator is
+// deterministic: the same parameters and seed give the same graph on every platform.
+// Random graphs are drawn by geometric skips over the vertex pairs, so they cost
+// O(n + m) rather than O(n^2) and sparse graphs with millions of vertices are cheap.
+
+enum class GraphFamily
+{
+    Gnp,          // Erdos-Renyi G(n, p)
+    HiddenClique, // G(n, p) with a planted clique whose degrees are camouflaged, like brock
+    Mycielski,    // Mycielski graphs: triangle-free with growing chromatic number
+    PowerLaw,     // Chung-Lu graph with a power-law expected degree sequence
+};
+
+struct GraphSpec
+{
+    GraphFamily family = GraphFamily::Gnp;
+    int n = 100;
+    double p = 0.5;            // edge probability: Gnp, HiddenClique
+    int clique = 10;           // planted clique size: HiddenClique
+    double hide = 1.0;         // HiddenClique: 0 keeps the clique's extra degree, 1 hides all of it
+    int order = 4;             // Mycielski: DIMACS mycielK numbering, chromatic number order + 1
+    double gamma = 2.5;        // PowerLaw: degree distribution exponent, above 2
+    double average_degree = 8; // PowerLaw
+    uint64_t seed = kDefaultSeed;
+};
+
+inline const char* GraphFamilyName(GraphFamily family)
+{
+    switch (family)
+    {
+    case GraphFamily::Gnp: return "gnp";
+    case GraphFamily::HiddenClique: return "hidden";
+    case GraphFamily::Mycielski: return "mycielski";
+    case GraphFamily::PowerLaw: return "powerlaw";
+    }
+    return "gnp";
+}
+
+inline bool ParseGraphFamily(const std::string& name, GraphFamily& family)
+{
+    for (GraphFamily f : {GraphFamily::Gnp, GraphFamily::HiddenClique, GraphFamily::Mycielski, GraphFamily::PowerLaw})
+    {
+        if (name == GraphFamilyName(f))
+        {
+            family = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A file name that spells out the parameters, e.g. gnp_n1000_p0.5_s1.clq
+inline std::string GraphSpecName(const GraphSpec& spec)
+{
+    auto real = [](double value)
+    {
+        std::string text = std::to_string(value);
+        text.erase(text.find_last_not_of('0') + 1);
+        if (text.back() == '.')
+            text.pop_back();
+        return text;
+    };
+    std::string name = GraphFamilyName(spec.family);
+    switch (spec.family)
+    {
+    case GraphFamily::Gnp:
+        name += "_n" + std::to_string(spec.n) + "_p" + real(spec.p);
+        break;
+    case GraphFamily::HiddenClique:
+        name += "_n" + std::to_string(spec.n) + "_p" + real(spec.p) + "_k" + std::to_string(spec.clique) + "_h" +
+                real(spec.hide);
+        break;
+    case GraphFamily::Mycielski:
+        return name + std::to_string(spec.order) + ".col";
+    case GraphFamily::PowerLaw:
+        name += "_n" + std::to_string(spec.n) + "_g" + real(spec.gamma) + "_d" + real(spec.average_degree);
+        break;
+    }
+    return name + "_s" + std::to_string(spec.seed) + ".clq";
+}
+
+namespace graph_gen_detail
+{
+    inline double UniformReal(Xoshiro256pp& rng)
+    {
+        return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+    }
+
+    // failures before the next success of Bernoulli(p) trials, p in (0, 1)
+    inline uint64_t GeometricSkip(Xoshiro256pp& rng, double log_failure)
+    {
+        const double skip = std::floor(std::log1p(-UniformReal(rng)) / log_failure);
+        return skip >= 1.0e18 ? uint64_t(1) << 60 : static_cast<uint64_t>(skip);
+    }
+
+    // Calls edge(u, v), u > v, for every pair kept with probability p (Batagelj, Brandes).
+    template <class EdgeFn>
+    void ForEachGnpPair(int n, double p, Xoshiro256pp& rng, EdgeFn edge)
+    {
+        if (p <= 0.0 || n < 2)
+            return;
+        if (p >= 1.0)
+        {
+            for (int u = 1; u < n; ++u)
+                for (int v = 0; v < u; ++v) edge(u, v);
+            return;
+        }
+        const double log_failure = std::log1p(-p);
+        int64_t u = 1;
+        int64_t v = -1;
+        while (u < n)
+        {
+            v += 1 + static_cast<int64_t>(GeometricSkip(rng, log_failure));
+            while (v >= u && u < n)
+            {
+                v -= u;
+                ++u;
+            }
+            if (u < n)
+                edge(static_cast<int>(u), static_cast<int>(v));
+        }
+    }
+
+    inline CsrGraph Build(int n, EdgeChunks& edges)
+    {
+        std::vector<EdgeChunks> parts(1);
+        parts[0] = std::move(edges);
+        return BuildCsrGraph(n, parts);
+    }
+}
+
+inline CsrGraph GenerateGnp(int n, double p, uint64_t seed)
+{
+    Xoshiro256pp rng(DeriveSeed(seed, 0));
+    EdgeChunks edges;
+    graph_gen_detail::ForEachGnpPair(n, p, rng, [&](int u, int v) { edges.Append(u, v); });
+    return graph_gen_detail::Build(n, edges);
+}
+
+// G(n, p) plus a clique on `k` random vertices. A planted clique is easy to spot because its
+// vertices gain about (k - 1)(1 - p) neighbours; as in the brock generator, edges from the
+// clique to the rest are dropped to take back a `hide` share of that excess, so that greedy
+// degree-based heuristics are led away from it.
+inline CsrGraph GenerateHiddenClique(int n, double p, int k, double hide, uint64_t seed)
+{
+    k = std::clamp(k, 0, n);
+    Xoshiro256pp rng(DeriveSeed(seed, 0));
+    std::vector<int> vertices(n);
+    std::iota(vertices.begin(), vertices.end(), 0);
+    for (int i = 0; i < k; ++i) std::swap(vertices[i], vertices[UniformInt(rng, i, n - 1)]);
+    std::vector<char> member(n, 0);
+    for (int i = 0; i < k; ++i) member[vertices[i]] = 1;
+
+    const double excess = (k - 1) * (1.0 - p);
+    const double outside = (n - k) * p;
+    const double drop = outside > 0.0 ? std::clamp(hide * excess / outside, 0.0, 1.0) : 0.0;
+
+    Xoshiro256pp edge_rng(DeriveSeed(seed, 1));
+    Xoshiro256pp drop_rng(DeriveSeed(seed, 2));
+    EdgeChunks edges;
+    graph_gen_detail::ForEachGnpPair(n, p, edge_rng, [&](int u, int v)
+    {
+        const int inside = member[u] + member[v];
+        if (inside == 2 || (inside == 1 && graph_gen_detail::UniformReal(drop_rng) < drop))
+            return;
+        edges.Append(u, v);
+    });
+    for (int i = 0; i < k; ++i)
+        for (int j = i + 1; j < k; ++j) edges.Append(vertices[i], vertices[j]);
+    return graph_gen_detail::Build(n, edges);
+}
+
+// DIMACS mycielK: K - 1 Mycielskian steps from an edge, 3 * 2^(K-1) - 1 vertices,
+// chromatic number K + 1 and no triangles. Hard for coloring bounds, trivial for clique.
+inline CsrGraph GenerateMycielski(int order)
+{
+    order = std::clamp(order, 1, 20);
+    std::vector<std::pair<int, int>> list = {{0, 1}};
+    int n = 2;
+    for (int step = 1; step < order; ++step)
+    {
+        // copy u' of every u is joined to the neighbours of u, the hub to every copy
+        const size_t original = list.size();
+        for (size_t e = 0; e < original; ++e)
+        {
+            const auto [a, b] = list[e];
+            list.emplace_back(a, n + b);
+            list.emplace_back(b, n + a);
+        }
+        for (int u = 0; u < n; ++u) list.emplace_back(n + u, 2 * n);
+        n = 2 * n + 1;
+    }
+    EdgeChunks edges;
+    for (const auto& [a, b] : list) edges.Append(a, b);
+    return graph_gen_detail::Build(n, edges);
+}
+
+// Chung-Lu graph: u and v are adjacent with probability min(1, w_u w_v / sum w) for expected
+// degrees w_i ~ (i + 1)^(-1 / (gamma - 1)), scaled to `average_degree` and capped at
+// sqrt(sum w). Pairs are skipped geometrically along the decreasing weights (Miller,
+// Hagberg), and the vertices are shuffled afterwards so that ids say nothing about degrees.
+inline CsrGraph GeneratePowerLaw(int n, double gamma, double average_degree, uint64_t seed)
+{
+    gamma = std::max(gamma, 2.01);
+    std::vector<double> weight(n);
+    const double exponent = -1.0 / (gamma - 1.0);
+    double raw_total = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        weight[i] = std::pow(i + 1.0, exponent);
+        raw_total += weight[i];
+    }
+    const double scale = raw_total > 0.0 ? average_degree * n / raw_total : 0.0;
+    const double cap = std::sqrt(average_degree * n);
+    double total = 0.0;
+    for (double& w : weight)
+    {
+        w = std::min(w * scale, cap);
+        total += w;
+    }
+
+    Xoshiro256pp rng(DeriveSeed(seed, 0));
+    std::vector<int> label(n);
+    std::iota(label.begin(), label.end(), 0);
+    for (int i = n - 1; i > 0; --i) std::swap(label[i], label[UniformInt(rng, 0, i)]);
+
+    EdgeChunks edges;
+    for (int u = 0; u + 1 < n && total > 0.0; ++u)
+    {
+        int v = u + 1;
+        double p = std::min(1.0, weight[u] * weight[v] / total);
+        while (v < n && p > 0.0)
+        {
+            if (p < 1.0)
+            {
+                const uint64_t skip = graph_gen_detail::GeometricSkip(rng, std::log1p(-p));
+                v = static_cast<int>(std::min<uint64_t>(static_cast<uint64_t>(v) + skip, static_cast<uint64_t>(n)));
+            }
+            if (v < n)
+            {
+                // weights only decrease along v, so thinning by q / p keeps every pair exact
+                const double q = std::min(1.0, weight[u] * weight[v] / total);
+                if (graph_gen_detail::UniformReal(rng) < q / p)
+                    edges.Append(label[u], label[v]);
+                p = q;
+                ++v;
+            }
+        }
+    }
+    return graph_gen_detail::Build(n, edges);
+}
+
+inline CsrGraph GenerateGraph(const GraphSpec& spec)
+{
+    switch (spec.family)
+    {
+    case GraphFamily::Gnp: return GenerateGnp(spec.n, spec.p, spec.seed);
+    case GraphFamily::HiddenClique: return GenerateHiddenClique(spec.n, spec.p, spec.clique, spec.hide, spec.seed);
+    case GraphFamily::Mycielski: return GenerateMycielski(spec.order);
+    case GraphFamily::PowerLaw: return GeneratePowerLaw(spec.n, spec.gamma, spec.average_degree, spec.seed);
+    }
+    return CsrGraph();
+}
+
+// 'c' lines that record how a graph was made
+inline std::vector<std::string> GraphSpecComments(const GraphSpec& spec)
+{
+    std::vector<std::string> lines = {std::string("generated by generate-graph ") + GraphFamilyName(spec.family)};
+    switch (spec.family)
+    {
+    case GraphFamily::Gnp:
+        lines.push_back("n " + std::to_string(spec.n) + " p " + std::to_string(spec.p));
+        break;
+    case GraphFamily::HiddenClique:
+        lines.push_back("n " + std::to_string(spec.n) + " p " + std::to_string(spec.p) + " clique " +
+                        std::to_string(spec.clique) + " hide " + std::to_string(spec.hide));
+        break;
+    case GraphFamily::Mycielski:
+        lines.push_back("order " + std::to_string(spec.order));
+        return lines;
+    case GraphFamily::PowerLaw:
+        lines.push_back("n " + std::to_string(spec.n) + " gamma " + std::to_string(spec.gamma) + " degree " +
+                        std::to_string(spec.average_degree));
+        break;
+    }
+    lines.push_back("seed " + std::to_string(spec.seed));
+    return lines;
+}
@@ -0,0 +1,527 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parallel.h"
+
+// Undirected graph in compressed sparse row form: the neighbours of v are
+// adjacency[offsets[v] .. offsets[v + 1]), sorted, without duplicates and self-loops.
+// Takes 8 bytes per edge (both directions as int) plus 8 bytes per vertex.
+//
+// A graph made by Borrow reads the caller's arrays in place instead: its own vectors stay
+// empty, and copying it copies two pointers. Code that builds or changes a graph works on
+// the vectors, so it only sees graphs of its own; readers go through Degree and Neighbours.
+struct CsrGraph
+{
+    int n = 0;
+    std::vector<uint64_t> offsets = {0};
+    std::vector<int> adjacency;
+
+    // offsets[0..n] and adjacency[0..offsets[n]] in the layout above, not copied; they
+    // must outlive the graph and every copy of it
+    static CsrGraph Borrow(int n, const uint64_t* offsets, const int* adjacency)
+    {
+        CsrGraph graph;
+        graph.n = n;
+        graph.borrowed_offsets = offsets;
+        graph.borrowed_adjacency = adjacency;
+        return graph;
+    }
+
+    bool IsBorrowed() const
+    {
+        return borrowed_offsets != nullptr;
+    }
+
+    int Degree(int v) const
+    {
+        const uint64_t* o = OffsetData();
+        return static_cast<int>(o[v + 1] - o[v]);
+    }
+
+    std::span<const int> Neighbours(int v) const
+    {
+        const uint64_t* o = OffsetData();
+        const int* a = IsBorrowed() ? borrowed_adjacency : adjacency.data();
+        return {a + o[v], a + o[v + 1]};
+    }
+
+    bool HasEdge(int u, int v) const
+    {
+        std::span<const int> neighbours = Neighbours(u);
+        return std::binary_search(neighbours.begin(), neighbours.end(), v);
+    }
+
+    int64_t EdgeCount() const
+    {
+        return static_cast<int64_t>(OffsetData()[n] / 2);
+    }
+
+private:
+    const uint64_t* OffsetData() const
+    {
+        return IsBorrowed() ? borrowed_offsets : offsets.data();
+    }
+
+    const uint64_t* borrowed_offsets = nullptr;
+    const int* borrowed_adjacency = nullptr;
+};
+
+// Append-only edge buffer. Edges go into fixed-size chunks, so growing the buffer never
+// copies it, and every edge takes 8 bytes packed as (min << 32) | max.
+class EdgeChunks
+{
+public:
+    static constexpr size_t kChunkEdges = size_t(1) << 20;
+
+    void Append(int u, int v)
+    {
+        if (chunks.empty() || chunks.back().size() == kChunkEdges)
+        {
+            chunks.emplace_back();
+            chunks.back().reserve(kChunkEdges);
+        }
+        const uint64_t lo = static_cast<uint32_t>(std::min(u, v));
+        const uint64_t hi = static_cast<uint32_t>(std::max(u, v));
+        chunks.back().push_back((lo << 32) | hi);
+    }
+
+    std::vector<std::vector<uint64_t>> chunks;
+};
+
+// Sorts and deduplicates every neighbourhood of a graph whose rows were filled in any order,
+// possibly with repeated neighbours, then closes the gaps left by the duplicates. The array
+// is reallocated to its final size only if duplicates took more than 1/8 of it, which then
+// briefly holds both arrays.
+inline void SortAndCompactRows(CsrGraph& graph, int threads)
+{
+    const int n = graph.n;
+    const int blocks = std::max(1, std::min(n, threads * 16));
+    std::vector<int> unique_degree(static_cast<size_t>(n));
+    ParallelFor(blocks, threads, [&](int b)
+    {
+        const int first = static_cast<int>(static_cast<int64_t>(n) * b / blocks);
+        const int last = static_cast<int>(static_cast<int64_t>(n) * (b + 1) / blocks);
+        for (int v = first; v < last; ++v)
+        {
+            int* begin = graph.adjacency.data() + graph.offsets[v];
+            int* end = graph.adjacency.data() + graph.offsets[v + 1];
+            std::sort(begin, end);
+            unique_degree[v] = static_cast<int>(std::unique(begin, end) - begin);
+        }
+    });
+
+    uint64_t write = 0;
+    for (int v = 0; v < n; ++v)
+    {
+        const uint64_t read = graph.offsets[v];
+        if (read != write)
+        {
+            std::copy(graph.adjacency.begin() + read, graph.adjacency.begin() + read + unique_degree[v],
+                      graph.adjacency.begin() + write);
+        }
+        graph.offsets[v] = write;
+        write += unique_degree[v];
+    }
+    graph.offsets[n] = write;
+    const uint64_t allocated = graph.adjacency.size();
+    graph.adjacency.resize(write);
+    if (write < allocated - allocated / 8)
+        graph.adjacency.shrink_to_fit();
+}
+
+// Offsets from the degree counts in `cursor`, which are replaced by the start of every row,
+// and the adjacency array allocated once for the scatter to fill.
+inline CsrGraph AllocateCsrRows(int n, std::vector<std::atomic<uint64_t>>& cursor)
+{
+    CsrGraph graph;
+    graph.n = n;
+    graph.offsets.assign(static_cast<size_t>(n) + 1, 0);
+    for (int v = 0; v < n; ++v)
+    {
+        graph.offsets[v + 1] = graph.offsets[v] + cursor[v].load(std::memory_order_relaxed);
+        cursor[v].store(graph.offsets[v], std::memory_order_relaxed);
+    }
+    graph.adjacency.resize(graph.offsets[n]);
+    return graph;
+}
+
+// Builds the CSR from edge buffers, releasing every chunk as soon as it is consumed:
+// counts degrees, scatters both directions, then sorts and deduplicates each
+// neighbourhood. All passes are parallel. Peak memory is the edge buffers plus the
+// adjacency array, so about 16 bytes per edge, and 8 bytes per edge afterwards.
+// ReadDimacsGraph avoids the buffers by parsing the file twice.
+inline CsrGraph BuildCsrGraph(int n, std::vector<EdgeChunks>& parts, int threads = DefaultThreadCount())
+{
+    std::vector<std::vector<uint64_t>*> chunks;
+    for (EdgeChunks& part : parts)
+        for (std::vector<uint64_t>& chunk : part.chunks)
+            chunks.push_back(&chunk);
+    const int chunk_count = static_cast<int>(chunks.size());
+
+    auto source = [](uint64_t edge) { return static_cast<int>(edge >> 32); };
+    auto target = [](uint64_t edge) { return static_cast<int>(edge & 0xFFFFFFFFULL); };
+
+    std::vector<std::atomic<uint64_t>> cursor(static_cast<size_t>(n));
+    ParallelFor(chunk_count, threads, [&](int c)
+    {
+        for (uint64_t edge : *chunks[c])
+        {
+            cursor[source(edge)].fetch_add(1, std::memory_order_relaxed);
+            cursor[target(edge)].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    CsrGraph graph = AllocateCsrRows(n, cursor);
+    ParallelFor(chunk_count, threads, [&](int c)
+    {
+        for (uint64_t edge : *chunks[c])
+        {
+            const int u = source(edge);
+            const int v = target(edge);
+            graph.adjacency[cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+            graph.adjacency[cursor[v].fetch_add(1, std::memory_order_relaxed)] = u;
+        }
+        std::vector<uint64_t>().swap(*chunks[c]);
+    });
+    std::vector<std::atomic<uint64_t>>().swap(cursor);
+    for (EdgeChunks& part : parts)
+        part.chunks.clear();
+
+    SortAndCompactRows(graph, threads);
+    return graph;
+}
+
+// What the DIMACS file declared and what was actually found in it.
+struct DimacsInfo
+{
+    int vertices = 0;
+    int64_t declared_edges = 0;
+    int64_t edge_lines = 0;    // well-formed 'e' lines, duplicates and self-loops included
+    int64_t invalid_lines = 0; // unparsable 'e' lines and vertex indices out of range
+};
+
+// Reads a file line by line in large blocks, tracking the file offset of each line.
+class DimacsLineReader
+{
+public:
+    static constexpr size_t kBlockSize = size_t(4) << 20;
+
+    DimacsLineReader(const std::string& filename, uint64_t offset)
+        : fin(filename, std::ios::binary), buffer(kBlockSize), file_offset(offset)
+    {
+        if (offset > 0)
+            fin.seekg(static_cast<std::streamoff>(offset));
+    }
+
+    bool IsOpen() const { return fin.is_open(); }
+
+    // Next line without its terminator; line_offset is where it starts in the file.
+    bool NextLine(std::string_view& line, uint64_t& line_offset)
+    {
+        while (true)
+        {
+            const char* newline = static_cast<const char*>(
+                memchr(buffer.data() + begin, '\n', end - begin));
+            if (newline != nullptr || (eof && begin < end))
+            {
+                const size_t line_end = newline ? static_cast<size_t>(newline - buffer.data()) : end;
+                line = std::string_view(buffer.data() + begin, line_end - begin);
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                line_offset = file_offset;
+                const size_t consumed = (newline ? line_end + 1 : line_end) - begin;
+                file_offset += consumed;
+                begin += consumed;
+                return true;
+            }
+            if (eof)
+                return false;
+            Refill();
+        }
+    }
+
+private:
+    void Refill()
+    {
+        // keep the unfinished line, growing the buffer if it does not fit
+        std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+        end -= begin;
+        begin = 0;
+        if (end == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        fin.read(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+        const size_t got = static_cast<size_t>(fin.gcount());
+        end += got;
+        if (got == 0)
+            eof = true;
+    }
+
+    std::ifstream fin;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+    uint64_t file_offset;
+};
+
+inline bool ParseDimacsInt(std::string_view& text, int64_t& value)
+{
+    size_t pos = text.find_first_not_of(" \t");
+    if (pos == std::string_view::npos)
+        return false;
+    auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    if (ec != std::errc())
+        return false;
+    text.remove_prefix(static_cast<size_t>(ptr - text.data()));
+    return true;
+}
+
+// Parses the 'e' lines that start in [begin, end) of the file, calling edge(u, v) with the
+// 0-based ends of every one that is not a self-loop.
+template <class EdgeFn>
+void ParseDimacsEdges(const std::string& filename, uint64_t begin, uint64_t end, int n, DimacsInfo& info,
+                      EdgeFn&& edge)
+{
+    // a line belongs to the range its first byte is in, so skip the tail of the previous one
+    uint64_t start = begin;
+    bool skip_first = false;
+    if (begin > 0)
+    {
+        start = begin - 1;
+        skip_first = true;
+    }
+    DimacsLineReader reader(filename, start);
+    std::string_view line;
+    uint64_t offset = 0;
+    if (skip_first && !reader.NextLine(line, offset))
+        return;
+    while (reader.NextLine(line, offset) && offset < end)
+    {
+        if (line.empty() || line[0] != 'e')
+            continue;
+        line.remove_prefix(1);
+        int64_t st = 0, fn = 0;
+        if (!ParseDimacsInt(line, st) || !ParseDimacsInt(line, fn) || st < 1 || st > n || fn < 1 || fn > n)
+        {
+            ++info.invalid_lines;
+            continue;
+        }
+        ++info.edge_lines;
+        if (st != fn)
+            edge(static_cast<int>(st - 1), static_cast<int>(fn - 1));
+    }
+}
+
+// Streaming DIMACS loader: the edge section is split into byte ranges parsed by separate
+// threads, twice. The first pass counts degrees, the second scatters every edge straight
+// into the adjacency array, which is allocated once in between, and no edge is buffered.
+// Peak memory is 8 bytes per 'e' line plus 16 bytes per vertex; lines that repeat an edge
+// are dropped at the end (see SortAndCompactRows).
+inline bool ReadDimacsGraph(const std::string& filename, CsrGraph& graph, DimacsInfo& info,
+                            int threads = DefaultThreadCount())
+{
+    info = DimacsInfo();
+    DimacsLineReader header_reader(filename, 0);
+    if (!header_reader.IsOpen())
+    {
+        std::cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+
+    std::string_view line;
+    uint64_t offset = 0;
+    bool header_found = false;
+    while (header_reader.NextLine(line, offset))
+    {
+        if (line.empty() || line[0] != 'p')
+            continue;
+        // p <type> <vertices> <edges>
+        line.remove_prefix(1);
+        size_t type_begin = line.find_first_not_of(" \t");
+        size_t type_end = type_begin == std::string_view::npos ? line.size() : line.find_first_of(" \t", type_begin);
+        line.remove_prefix(type_end == std::string_view::npos ? line.size() : type_end);
+        int64_t vertices = 0, edges = 0;
+        if (!ParseDimacsInt(line, vertices) || !ParseDimacsInt(line, edges) || vertices < 0 || vertices > INT32_MAX)
+        {
+            std::cerr << "Error: Failed to parse header line in file '" << filename << "'\n";
+            return false;
+        }
+        info.vertices = static_cast<int>(vertices);
+        info.declared_edges = edges;
+        header_found = true;
+        break;
+    }
+    if (!header_found)
+    {
+        std::cerr << "Error: Header line (starting with 'p') not found in file '" << filename << "'\n";
+        return false;
+    }
+
+    // the header line itself is skipped by the edge parsers like any other non-'e' line
+    const uint64_t body_begin = offset;
+    std::error_code ec;
+    const uint64_t file_size = std::filesystem::file_size(filename, ec);
+    const uint64_t body_size = ec || file_size < body_begin ? 0 : file_size - body_begin;
+    // ranges under a few megabytes are not worth a thread
+    const uint64_t min_range = uint64_t(4) << 20;
+    const int ranges = static_cast<int>(std::max<uint64_t>(1, std::min<uint64_t>(threads, body_size / min_range)));
+
+    const int n = info.vertices;
+    auto for_each_range = [&](std::vector<DimacsInfo>& part_info, auto&& edge)
+    {
+        ParallelFor(ranges, ranges, [&](int r)
+        {
+            const uint64_t begin = body_begin + body_size * r / ranges;
+            const uint64_t end = r + 1 == ranges ? UINT64_MAX : body_begin + body_size * (r + 1) / ranges;
+            ParseDimacsEdges(filename, begin, end, n, part_info[r], edge);
+        });
+    };
+
+    std::vector<std::atomic<uint64_t>> cursor(static_cast<size_t>(n));
+    std::vector<DimacsInfo> part_info(ranges);
+    for_each_range(part_info, [&](int u, int v)
+    {
+        cursor[u].fetch_add(1, std::memory_order_relaxed);
+        cursor[v].fetch_add(1, std::memory_order_relaxed);
+    });
+    for (const DimacsInfo& part : part_info)
+    {
+        info.edge_lines += part.edge_lines;
+        info.invalid_lines += part.invalid_lines;
+    }
+
+    graph = AllocateCsrRows(n, cursor);
+    std::vector<DimacsInfo> scatter_info(ranges);
+    std::atomic<bool> overflow{false};
+    for_each_range(scatter_info, [&](int u, int v)
+    {
+        const uint64_t at_u = cursor[u].fetch_add(1, std::memory_order_relaxed);
+        const uint64_t at_v = cursor[v].fetch_add(1, std::memory_order_relaxed);
+        if (at_u >= graph.offsets[u + 1] || at_v >= graph.offsets[v + 1])
+        {
+            overflow.store(true, std::memory_order_relaxed);
+            return;
+        }
+        graph.adjacency[at_u] = v;
+        graph.adjacency[at_v] = u;
+    });
+    std::vector<std::atomic<uint64_t>>().swap(cursor);
+    int64_t scattered_lines = 0;
+    for (const DimacsInfo& part : scatter_info) scattered_lines += part.edge_lines;
+    if (overflow || scattered_lines != info.edge_lines)
+    {
+        std::cerr << "Error: File '" << filename << "' changed while it was read\n";
+        graph = CsrGraph();
+        return false;
+    }
+    SortAndCompactRows(graph, threads);
+    return true;
+}
+
+// Vertex weights from the "n <vertex> <weight>" lines of a weighted DIMACS file; vertices
+// without such a line weigh 1. Returns false if the file cannot be read or has no weights.
+inline bool ReadDimacsWeights(const std::string& filename, int n, std::vector<int64_t>& weights)
+{
+    DimacsLineReader reader(filename, 0);
+    if (!reader.IsOpen())
+    {
+        std::cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+    weights.assign(n, 1);
+    std::string_view line;
+    uint64_t offset = 0;
+    int64_t found = 0;
+    while (reader.NextLine(line, offset))
+    {
+        if (line.empty() || line[0] != 'n')
+            continue;
+        line.remove_prefix(1);
+        int64_t v = 0, w = 0;
+        if (!ParseDimacsInt(line, v) || !ParseDimacsInt(line, w) || v < 1 || v > n)
+        {
+            std::cerr << "Warning: Skipping invalid weight line in file '" << filename << "'\n";
+            continue;
+        }
+        weights[v - 1] = w;
+        ++found;
+    }
+    if (found == 0)
+    {
+        std::cerr << "Error: No 'n' weight lines in file '" << filename << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Sidecar weight file: the weights of vertices 1..n in order, separated by whitespace.
+inline bool ReadWeightsFile(const std::string& filename, int n, std::vector<int64_t>& weights)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open())
+    {
+        std::cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+    weights.assign(n, 0);
+    for (int v = 0; v < n; ++v)
+    {
+        if (!(fin >> weights[v]))
+        {
+            std::cerr << "Error: Expected " << n << " weights in file '" << filename << "'\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes `graph` as a DIMACS edge file, every edge once, after `comments` as 'c' lines.
+inline bool WriteDimacsGraph(const std::string& filename, const CsrGraph& graph,
+                             const std::vector<std::string>& comments = {})
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "Error: Cannot write file '" << filename << "'\n";
+        return false;
+    }
+    for (const std::string& comment : comments) out << "c " << comment << '\n';
+    out << "p edge " << graph.n << ' ' << graph.EdgeCount() << '\n';
+
+    // edge lines are formatted into a block buffer, the stream sees one write per block
+    std::string block;
+    block.reserve(DimacsLineReader::kBlockSize + 32);
+    char number[16];
+    for (int u = 0; u < graph.n; ++u)
+    {
+        for (int v : graph.Neighbours(u))
+        {
+            if (v < u)
+                continue;
+            block += "e ";
+            block.append(number, std::to_chars(number, number + sizeof(number), u + 1).ptr);
+            block += ' ';
+            block.append(number, std::to_chars(number, number + sizeof(number), v + 1).ptr);
+            block += '\n';
+            if (block.size() >= DimacsLineReader::kBlockSize)
+            {
+                out.write(block.data(), static_cast<std::streamsize>(block.size()));
+                block.clear();
+            }
+        }
+    }
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "graph_io.h"
+#include "random.h"
+#include "vertex_order.h"
+
+// GRASP for the maximum clique problem (lab2): every iteration builds a maximal clique by a
+// randomized greedy choice from a restricted candidate list of the best scored vertices.
+// Weights of the greedy score of a candidate vertex: its degree among the candidates, how
+// many nearly isolated candidates it keeps alive, the average and minimum candidate degree
+// of its neighbours and a look-ahead over its first neighbours.
+struct GraspWeights
+{
+    int degree = 1000;
+    int critical = 100;
+    int average = 10;
+    int minimum = 20;
+    int potential = 5;
+};
+
+// Rng: random engine of the search, see Next32 in random.h for the requirements
+template <class Rng = Xoshiro256pp>
+class MaxCliqueProblem
+{
+public:
+    explicit MaxCliqueProblem(uint64_t seed = kDefaultSeed)
+        : seed(seed), iteration_seed(DeriveSeed(seed, 0)), generator(DeriveSeed(seed, 0))
+    {
+    }
+
+    // ordering: vertex ids are relabeled for locality, GetClique reports the file's ids
+    void ReadGraphFile(std::string filename, VertexOrdering ordering = VertexOrdering::None)
+    {
+        DimacsInfo info;
+        if (!ReadDimacsGraph(filename, graph, info))
+        {
+            return;
+        }
+        relabeling = RelabelGraph(graph, ordering);
+
+        if (info.invalid_lines > 0)
+        {
+            std::cerr << "Warning: Skipped " << info.invalid_lines << " invalid edge lines in file '" << filename << "'\n";
+        }
+
+        if (info.edge_lines != info.declared_edges)
+        {
+            std::cout << "Warning: Expected " << info.declared_edges << " edges, but read " << info.edge_lines << " edges from file '" << filename << "'\n";
+        }
+    }
+
+    // a graph that is already in memory, instead of ReadGraphFile; a borrowed one
+    // (CsrGraph::Borrow) is read in place
+    void SetGraph(CsrGraph csr)
+    {
+        graph = std::move(csr);
+        relabeling = VertexRelabeling();
+    }
+
+    void SetWeights(const GraspWeights& score_weights)
+    {
+        weights = score_weights;
+    }
+
+    // FindClique stops starting new iterations `seconds` after this call; 0 for no limit.
+    // A search cut short this way depends on timing even in deterministic mode.
+    void SetTimeLimit(double seconds)
+    {
+        has_deadline = seconds > 0.0;
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // GRASP algorithm for Maximum Clique Problem
+    // randomization: size of Restricted Candidate List (RCL)
+    // iterations: number of GRASP iterations
+    // threads: iterations are shared between this many worker threads
+    // deterministic: each iteration draws from its own stream derived from the seed and ties
+    // go to the lowest iteration, so the result does not depend on thread scheduling
+    void FindClique(int randomization, int iterations, int threads = 1, bool deterministic = false)
+    {
+        threads = std::max(1, std::min(threads, iterations));
+        if (threads == 1 && !deterministic)
+        {
+            Scratch scratch;
+            for (int iteration = 0; iteration < iterations && !TimeUp(); ++iteration)
+            {
+                std::vector<int> clique = BuildClique(randomization, generator, scratch);
+                if (clique.size() > best_clique.size())
+                {
+                    best_clique = std::move(clique);
+                }
+            }
+            return;
+        }
+
+        std::atomic<int> next_iteration{0};
+        std::mutex best_mutex;
+        int best_iteration = -1; // -1: clique found by an earlier call
+        auto worker = [&](int thread_id)
+        {
+            Scratch scratch;
+            Rng thread_generator(DeriveSeed(seed, 1 + thread_id));
+            std::vector<int> local_best;
+            int local_best_iteration = -1;
+            // iterations are claimed in increasing order, so the first strictly larger clique
+            // is also the one from the lowest iteration
+            for (int iteration = next_iteration++; iteration < iterations && !TimeUp(); iteration = next_iteration++)
+            {
+                if (deterministic)
+                {
+                    thread_generator.seed(DeriveSeed(iteration_seed, iteration));
+                }
+                std::vector<int> clique = BuildClique(randomization, thread_generator, scratch);
+                if (clique.size() > local_best.size())
+                {
+                    local_best = std::move(clique);
+                    local_best_iteration = iteration;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(best_mutex);
+            if (local_best.size() > best_clique.size() ||
+                (local_best.size() == best_clique.size() && best_iteration > local_best_iteration))
+            {
+                best_clique = std::move(local_best);
+                best_iteration = local_best_iteration;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(worker, t);
+        }
+        for (std::thread& w : workers)
+        {
+            w.join();
+        }
+    }
+    
+
+    
+
+    std::vector<int> GetClique()
+    {
+        return relabeling.ToOriginal(best_clique);
+    }
+
+    bool IsGraphValid()
+    {
+        return graph.n > 0;
+    }
+
+    int GetVertexCount()
+    {
+        return graph.n;
+    }
+
+    bool Check()
+    {
+        if (std::unique(best_clique.begin(), best_clique.end()) != best_clique.end())
+        {
+            std::cout << "Duplicated vertices in the clique\n";
+            return false;
+        }
+        for (int i : best_clique)
+        {
+            for (int j : best_clique)
+            {
+                if (i != j && !graph.HasEdge(i, j))
+                {
+                    std::cout << "Returned subgraph is not a clique\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    // buffers reused between iterations to avoid allocations
+    struct Scratch
+    {
+        std::vector<int> candidate_degrees;
+        std::vector<std::pair<int, int>> candidate_scores;
+        std::vector<int> cumulative_weights;
+        std::vector<int> new_candidates;
+    };
+
+    bool TimeUp() const
+    {
+        return has_deadline && std::chrono::steady_clock::now() >= deadline;
+    }
+
+    static int GetRandom(Rng& generator, int a, int b)
+    {
+        return UniformInt(generator, a, b);
+    }
+
+    // one GRASP construction: randomized greedy build of a maximal clique
+    std::vector<int> BuildClique(int randomization, Rng& generator, Scratch& scratch) const
+    {
+        std::vector<int> clique;
+        std::vector<int> candidates;
+        candidates.reserve(graph.n);
+        for (int i = 0; i < graph.n; ++i)
+        {
+            candidates.push_back(i);
+        }
+        
+        // use vector<bool> for faster candidate lookup
+        std::vector<bool> is_candidate(graph.n, false);
+        for (int c : candidates)
+        {
+            is_candidate[c] = true;
+        }
+        
+        // diversity: sometimes start with a high-degree vertex to explore different regions
+        // 25% of iterations start with a pre-selected high-degree vertex
+        if (GetRandom(generator, 0, 100) < 25 && !candidates.empty())
+        {
+            // find vertex with maximum degree in current candidate set
+            int max_degree_vertex = candidates[0];
+            int max_degree = 0;
+            for (int v : candidates)
+            {
+                int degree = graph.Degree(v);
+                if (degree > max_degree)
+                {
+                    max_degree = degree;
+                    max_degree_vertex = v;
+                }
+            }
+            
+            clique.push_back(max_degree_vertex);
+            is_candidate[max_degree_vertex] = false;
+            
+            std::vector<int> new_candidates;
+            new_candidates.reserve(candidates.size());
+            for (int c : candidates)
+            {
+                if (c != max_degree_vertex && graph.HasEdge(max_degree_vertex, c))
+                {
+                    new_candidates.push_back(c);
+                }
+                else
+                {
+                    is_candidate[c] = false;
+                }
+            }
+            candidates = std::move(new_candidates);
+        }
+        
+        // build clique iteratively until no candidates remain
+        // reuse vectors to avoid allocations
+        std::vector<int>& candidate_degrees = scratch.candidate_degrees;
+        candidate_degrees.assign(graph.n, 0);
+        
+        while (!candidates.empty())
+        {
+            int max_degree = 0;
+            for (int v : candidates)
+            {
+                int degree = 0;
+                const auto neighbors_v = graph.Neighbours(v);
+                for (int neighbor : neighbors_v)
+                {
+                    degree += is_candidate[neighbor] ? 1 : 0;
+                }
+                candidate_degrees[v] = degree;
+                if (degree > max_degree)
+                {
+                    max_degree = degree;
+                }
+            }
+            
+            // compute improved scores for all candidates
+            std::vector<std::pair<int, int>>& candidate_scores = scratch.candidate_scores;
+            candidate_scores.clear();
+            candidate_scores.reserve(candidates.size());
+            
+            // precompute critical_threshold once (same for all vertices)
+            int critical_threshold = std::max(2, max_degree / 4);
+            
+            for (int v : candidates)
+            {
+                int degree = candidate_degrees[v];
+                
+                // analyze neighbors to compute additional metrics
+                int critical_neighbors = 0;      // neighbors with very low degree
+                int total_neighbor_degree = 0;    // sum of neighbor degrees
+                int min_neighbor_degree = INT_MAX; // minimum neighbor degree
+                int potential = 0;                // look-ahead
+                int neighbor_count = 0;
+                int potential_limit = std::min(15, degree); // precompute limit
+                
+                const auto neighbors_v = graph.Neighbours(v);
+                for (int neighbor : neighbors_v)
+                {
+                    if (is_candidate[neighbor])
+                    {
+                        int n_degree = candidate_degrees[neighbor];
+                        total_neighbor_degree += n_degree;
+                        if (n_degree < min_neighbor_degree)
+                        {
+                            min_neighbor_degree = n_degree;
+                        }
+                        
+                        // Look-ahead
+                        if (neighbor_count < potential_limit)
+                        {
+                            potential += n_degree;
+                        }
+                        
+
+                        if (n_degree <= critical_threshold)
+                        {
+                            critical_neighbors += (critical_threshold - n_degree + 1);
+                        }
+                        
+                        neighbor_count++;
+                    }
+                }
+                
+                int avg_neighbor_degree = (neighbor_count > 0) ? (total_neighbor_degree / neighbor_count) : 0;
+                if (min_neighbor_degree == INT_MAX) min_neighbor_degree = 0;
+                
+
+                int score = degree * weights.degree 
+                          + critical_neighbors * weights.critical 
+                          + avg_neighbor_degree * weights.average
+                          + min_neighbor_degree * weights.minimum
+                          + potential * weights.potential;
+                
+                candidate_scores.push_back({v, score});
+            }
+            
+            int rcl_size = std::min(randomization, (int)candidate_scores.size());
+            if (rcl_size == 0) rcl_size = 1;
+            
+            // use partial_sort
+            if (rcl_size < candidate_scores.size())
+            {
+                // partial_sort is often faster for small k
+                std::partial_sort(candidate_scores.begin(), candidate_scores.begin() + rcl_size,
+                                  candidate_scores.end(),
+                                  [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                                      return a.second > b.second;
+                                  });
+            }
+            else
+            {
+                // if rcl_size == size, just sort all
+                std::sort(candidate_scores.begin(), candidate_scores.end(),
+                          [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                              return a.second > b.second;
+                          });
+            }
+            
+            // expand RCL to include all candidates with same score
+            int min_score_in_rcl = candidate_scores[rcl_size - 1].second;
+            int actual_rcl_size = rcl_size;
+            for (int i = rcl_size; i < candidate_scores.size(); ++i)
+            {
+                if (candidate_scores[i].second == min_score_in_rcl)
+                {
+                    actual_rcl_size++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            
+            // weighted random selection from RCL
+            int selected_idx;
+            if (actual_rcl_size <= 3)
+            {
+                // for small RCL, uniform random is fine
+                selected_idx = GetRandom(generator, 0, actual_rcl_size - 1);
+            }
+            else
+            {
+                // use linear weighting for simplicity and speed
+                int max_score = candidate_scores[0].second;
+                int min_score_in_rcl = candidate_scores[actual_rcl_size - 1].second;
+                int score_range = max_score - min_score_in_rcl;
+                
+                if (score_range > 0)
+                {
+                    // precompute division for efficiency
+                    int score_range_div = std::max(1, score_range);
+                    
+                    // calculate total weight and cumulative weights in one pass
+                    int total_weight = 0;
+                    std::vector<int>& cumulative_weights = scratch.cumulative_weights;
+                    cumulative_weights.clear();
+                    cumulative_weights.reserve(actual_rcl_size);
+                    
+                    for (int i = 0; i < actual_rcl_size; ++i)
+                    {
+                        int normalized_score = candidate_scores[i].second - min_score_in_rcl;
+                        int weight = 1 + (normalized_score * 10) / score_range_div;
+                        total_weight += weight;
+                        cumulative_weights.push_back(total_weight);
+                    }
+                    
+                    // select based on cumulative weights
+                    int random_val = GetRandom(generator, 0, total_weight - 1);
+                    for (int i = 0; i < actual_rcl_size; ++i)
+                    {
+                        if (random_val < cumulative_weights[i])
+                        {
+                            selected_idx = i;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    // all scores are equal, use uniform random
+                    selected_idx = GetRandom(generator, 0, actual_rcl_size - 1);
+                }
+            }
+            
+            int selected_vertex = candidate_scores[selected_idx].first;
+            
+            // add selected vertex to clique
+            clique.push_back(selected_vertex);
+            
+            // update candidates: keep only neighbors of selected vertex (optimized)
+            is_candidate[selected_vertex] = false;
+            std::vector<int>& new_candidates = scratch.new_candidates;
+            new_candidates.clear();
+            
+            // this is faster when selected vertex has fewer neighbors than candidates
+            const auto selected_neighbors = graph.Neighbours(selected_vertex);
+            if (selected_neighbors.size() < candidates.size())
+            {
+                new_candidates.reserve(selected_neighbors.size());
+                for (int neighbor : selected_neighbors)
+                {
+                    if (is_candidate[neighbor])
+                    {
+                        new_candidates.push_back(neighbor);
+                    }
+                }
+                // mark all old candidates as false, then restore true for new ones
+                for (int c : candidates)
+                {
+                    is_candidate[c] = false;
+                }
+                for (int c : new_candidates)
+                {
+                    is_candidate[c] = true;
+                }
+            }
+            else
+            {
+                new_candidates.reserve(candidates.size());
+                for (int c : candidates)
+                {
+                    if (c != selected_vertex && graph.HasEdge(selected_vertex, c))
+                    {
+                        new_candidates.push_back(c);
+                        // is_candidate[c] remains true
+                    }
+                    else
+                    {
+                        is_candidate[c] = false;
+                    }
+                }
+            }
+            candidates = std::move(new_candidates);
+        }
+
+        return clique;
+    }
+
+    uint64_t seed;
+    uint64_t iteration_seed;
+    Rng generator;
+    CsrGraph graph;
+    VertexRelabeling relabeling;
+    std::vector<int> best_clique;
+    GraspWeights weights;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+};
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bit_graph.h"
+#include "graph_io.h"
+
+// Adjacency rows that are dense bitsets where that is compact and Roaring-style compressed
+// sets elsewhere (Lemire et al.), chosen per row. A compressed row splits the vertex ids
+// into chunks of 2^16 and keeps each non-empty chunk in the smallest of three containers:
+// a sorted array of the low 16 bits, a 2^16-bit bitmap or a list of runs. At n = 100k a
+// dense row takes 12.5 KB whatever the degree, so a sparse graph shrinks from n^2 / 8 bytes
+// to a few bytes per edge while its hubs keep word-parallel rows.
+//
+// The interface is the row operations of BitGraph, so ColoringEngine, MaxSatBound and the
+// B&B run on either. Operations on compressed rows visit the row as (word index, mask)
+// pairs, which keeps them word-parallel on bitmaps and runs.
+class HybridBitGraph
+{
+public:
+    int n = 0;
+    int words = 0;
+
+    HybridBitGraph() = default;
+
+    // force_dense: every row dense, exactly like BitGraph
+    explicit HybridBitGraph(const CsrGraph& csr, bool force_dense = false)
+        : n(csr.n), words(BitsetWords(csr.n)), dense_index(csr.n, -1), first_container(csr.n + 1, 0)
+    {
+        // the kind of every row first, so that the dense matrix is allocated once
+        for (int v = 0; v < n; ++v)
+        {
+            if (force_dense || DenseBytes() <= kMinSaving * CompressedBytes(csr.Neighbours(v)))
+                dense_index[v] = dense_rows++;
+        }
+        dense.assign(static_cast<size_t>(dense_rows) * words, 0ULL);
+        for (int v = 0; v < n; ++v)
+        {
+            std::span<const int> neighbours = csr.Neighbours(v);
+            if (dense_index[v] >= 0)
+            {
+                uint64_t* row = dense.data() + static_cast<size_t>(dense_index[v]) * words;
+                for (int u : neighbours) SetBit(row, u);
+            }
+            else
+            {
+                Compress(neighbours);
+            }
+            first_container[v + 1] = static_cast<uint32_t>(containers.size());
+        }
+    }
+
+    int DenseRows() const
+    {
+        return dense_rows;
+    }
+
+    size_t MemoryBytes() const
+    {
+        return dense.size() * sizeof(uint64_t) + containers.size() * sizeof(Container) +
+               values.size() * sizeof(uint16_t) + bitmaps.size() * sizeof(uint64_t);
+    }
+
+    inline bool IsAdjacent(int u, int v) const
+    {
+        if (dense_index[u] >= 0)
+            return TestBit(DenseRow(u), v);
+        return (RowWord(u, v >> 6) >> (v & 63)) & 1ULL;
+    }
+
+    // bits |= row(v)
+    inline void OrRow(uint64_t* bits, int v) const
+    {
+        if (dense_index[v] >= 0)
+            return OrEq(bits, DenseRow(v), words);
+        ForEachRowWord(v, [&](int w, uint64_t mask) { bits[w] |= mask; });
+    }
+
+    // bits &= ~row(v), from word `first_word` on
+    inline void AndNotRow(uint64_t* bits, int v, int first_word = 0) const
+    {
+        if (dense_index[v] >= 0)
+        {
+            const uint64_t* row = DenseRow(v);
+            for (int w = first_word; w < words; ++w) bits[w] &= ~row[w];
+            return;
+        }
+        ForEachRowWord(v, [&](int w, uint64_t mask)
+        {
+            if (w >= first_word)
+                bits[w] &= ~mask;
+        });
+    }
+
+    // bits &= row(v)
+    inline void AndRow(uint64_t* bits, int v) const
+    {
+        if (dense_index[v] >= 0)
+        {
+            const uint64_t* row = DenseRow(v);
+            for (int w = 0; w < words; ++w) bits[w] &= row[w];
+            return;
+        }
+        for (int w = 0; w < words; ++w)
+            if (bits[w] != 0ULL) bits[w] &= RowWord(v, w);
+    }
+
+    // |row(v) & bits|
+    inline int RowAndPopCount(int v, const uint64_t* bits) const
+    {
+        if (dense_index[v] >= 0)
+            return AndPopCount(DenseRow(v), bits, words);
+        int count = 0;
+        ForEachRowWord(v, [&](int w, uint64_t mask) { count += std::popcount(bits[w] & mask); });
+        return count;
+    }
+
+    // f(u) for every neighbour u of v in bits, in increasing order
+    template <class F>
+    inline void ForEachNeighbourIn(int v, const uint64_t* bits, F&& f) const
+    {
+        if (dense_index[v] >= 0)
+        {
+            const uint64_t* row = DenseRow(v);
+            for (int w = 0; w < words; ++w)
+            {
+                for (uint64_t word = row[w] & bits[w]; word != 0ULL; word &= word - 1)
+                    f(w * 64 + std::countr_zero(word));
+            }
+            return;
+        }
+        ForEachRowWord(v, [&](int w, uint64_t mask)
+        {
+            for (uint64_t word = bits[w] & mask; word != 0ULL; word &= word - 1)
+                f(w * 64 + std::countr_zero(word));
+        });
+    }
+
+    // appends the neighbours of v among from[0..count) to `out`, keeping their order
+    inline void SelectAdjacent(int v, const std::vector<int>& from, int count, std::vector<int>& out) const
+    {
+        if (dense_index[v] >= 0)
+        {
+            const uint64_t* row = DenseRow(v);
+            for (int j = 0; j < count; ++j)
+                if (TestBit(row, from[j])) out.push_back(from[j]);
+            return;
+        }
+        if (count <= kSearchLimit)
+        {
+            for (int j = 0; j < count; ++j)
+                if (IsAdjacent(v, from[j])) out.push_back(from[j]);
+            return;
+        }
+        // many tests, e.g. at the B&B root: spread the row into a scratch bitset, then clear it
+        thread_local std::vector<uint64_t> scratch;
+        scratch.resize(words, 0ULL);
+        ForEachRowWord(v, [&](int w, uint64_t mask) { scratch[w] |= mask; });
+        for (int j = 0; j < count; ++j)
+            if (TestBit(scratch.data(), from[j])) out.push_back(from[j]);
+        ForEachRowWord(v, [&](int w, uint64_t) { scratch[w] = 0ULL; });
+    }
+
+    // HashWords of the whole matrix as dense rows, so a checkpoint does not depend on the layout
+    uint64_t Hash() const
+    {
+        const size_t count = static_cast<size_t>(n) * words;
+        uint64_t h = 0x9E3779B97F4A7C15ULL ^ count;
+        std::vector<uint64_t> row(words);
+        for (int v = 0; v < n; ++v)
+        {
+            std::fill(row.begin(), row.end(), 0ULL);
+            OrRow(row.data(), v);
+            for (uint64_t word : row)
+            {
+                h ^= word + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+                h *= 0xBF58476D1CE4E5B9ULL;
+            }
+        }
+        return h;
+    }
+
+private:
+    enum class Kind : uint8_t
+    {
+        Array,  // sorted low bits, `size` of them
+        Bitmap, // 1024 words
+        Runs,   // `size` pairs (start, length - 1)
+    };
+
+    struct Container
+    {
+        uint32_t key;    // high 16 bits of the vertex ids
+        Kind kind;
+        uint32_t offset; // into values (Array, Runs) or bitmaps (Bitmap)
+        uint32_t size;
+    };
+
+    static constexpr int kChunkBits = 16;
+    static constexpr int kChunkWords = (1 << kChunkBits) / 64;
+    static constexpr int kMaxArray = 4096; // above this a bitmap is never larger
+    static constexpr int kSearchLimit = 64; // SelectAdjacent: binary searches up to this many
+    static constexpr size_t kMinSaving = 4; // dense rows are faster, so compress only when 4x smaller
+
+    size_t DenseBytes() const
+    {
+        return static_cast<size_t>(words) * sizeof(uint64_t);
+    }
+
+    // each chunk in its smallest container, as Compress will store it
+    static size_t CompressedBytes(std::span<const int> neighbours)
+    {
+        size_t bytes = 0;
+        ForEachChunk(neighbours, [&](std::span<const int> chunk)
+        {
+            bytes += sizeof(Container) + std::min({ArrayBytes(chunk), RunBytes(chunk), BitmapBytes()});
+        });
+        return bytes;
+    }
+
+    static size_t ArrayBytes(std::span<const int> chunk)
+    {
+        return chunk.size() <= static_cast<size_t>(kMaxArray) ? chunk.size() * sizeof(uint16_t) : SIZE_MAX;
+    }
+
+    static size_t RunBytes(std::span<const int> chunk)
+    {
+        return 2 * sizeof(uint16_t) * static_cast<size_t>(CountRuns(chunk));
+    }
+
+    static size_t BitmapBytes()
+    {
+        return kChunkWords * sizeof(uint64_t);
+    }
+
+    static int CountRuns(std::span<const int> chunk)
+    {
+        int runs = 0;
+        for (size_t i = 0; i < chunk.size(); ++i) runs += i == 0 || chunk[i] != chunk[i - 1] + 1;
+        return runs;
+    }
+
+    // f(chunk) for the sorted neighbours of every 2^16 block
+    template <class F>
+    static void ForEachChunk(std::span<const int> neighbours, F&& f)
+    {
+        for (size_t begin = 0; begin < neighbours.size();)
+        {
+            size_t end = begin;
+            const int key = neighbours[begin] >> kChunkBits;
+            while (end < neighbours.size() && (neighbours[end] >> kChunkBits) == key) ++end;
+            f(neighbours.subspan(begin, end - begin));
+            begin = end;
+        }
+    }
+
+    void Compress(std::span<const int> neighbours)
+    {
+        ForEachChunk(neighbours, [&](std::span<const int> chunk)
+        {
+            Container c;
+            c.key = static_cast<uint32_t>(chunk[0] >> kChunkBits);
+            const size_t array = ArrayBytes(chunk), runs = RunBytes(chunk), bitmap = BitmapBytes();
+            if (array <= runs && array <= bitmap)
+            {
+                c.kind = Kind::Array;
+                c.offset = static_cast<uint32_t>(values.size());
+                c.size = static_cast<uint32_t>(chunk.size());
+                for (int u : chunk) values.push_back(static_cast<uint16_t>(u & 0xFFFF));
+            }
+            else if (runs <= bitmap)
+            {
+                c.kind = Kind::Runs;
+                c.offset = static_cast<uint32_t>(values.size());
+                c.size = static_cast<uint32_t>(CountRuns(chunk));
+                for (size_t i = 0; i < chunk.size();)
+                {
+                    size_t j = i + 1;
+                    while (j < chunk.size() && chunk[j] == chunk[j - 1] + 1) ++j;
+                    values.push_back(static_cast<uint16_t>(chunk[i] & 0xFFFF));
+                    values.push_back(static_cast<uint16_t>(j - i - 1));
+                    i = j;
+                }
+            }
+            else
+            {
+                c.kind = Kind::Bitmap;
+                c.offset = static_cast<uint32_t>(bitmaps.size());
+                c.size = static_cast<uint32_t>(chunk.size());
+                bitmaps.resize(bitmaps.size() + kChunkWords, 0ULL);
+                for (int u : chunk) SetBit(bitmaps.data() + c.offset, u & 0xFFFF);
+            }
+            containers.push_back(c);
+        });
+    }
+
+    inline const uint64_t* DenseRow(int v) const
+    {
+        return dense.data() + static_cast<size_t>(dense_index[v]) * words;
+    }
+
+    // f(word index, bits of row(v) in that word) for the non-zero words of a compressed row
+    template <class F>
+    inline void ForEachRowWord(int v, F&& f) const
+    {
+        for (uint32_t k = first_container[v]; k < first_container[v + 1]; ++k)
+        {
+            const Container& c = containers[k];
+            const int base = static_cast<int>(c.key) * kChunkWords;
+            if (c.kind == Kind::Array)
+            {
+                const uint16_t* x = values.data() + c.offset;
+                for (uint32_t i = 0; i < c.size;)
+                {
+                    const int w = x[i] >> 6;
+                    uint64_t mask = 0;
+                    for (; i < c.size && (x[i] >> 6) == w; ++i) mask |= 1ULL << (x[i] & 63);
+                    f(base + w, mask);
+                }
+            }
+            else if (c.kind == Kind::Bitmap)
+            {
+                const uint64_t* bitmap = bitmaps.data() + c.offset;
+                for (int w = 0; w < kChunkWords; ++w)
+                    if (bitmap[w] != 0ULL) f(base + w, bitmap[w]);
+            }
+            else
+            {
+                const uint16_t* x = values.data() + c.offset;
+                for (uint32_t r = 0; r < c.size; ++r)
+                {
+                    int first = x[2 * r];
+                    const int last = first + x[2 * r + 1];
+                    while (first <= last)
+                    {
+                        const int w = first >> 6;
+                        const int end = std::min(last, w * 64 + 63);
+                        const int width = end - first + 1;
+                        const uint64_t mask = (width == 64 ? ~0ULL : ((1ULL << width) - 1)) << (first & 63);
+                        f(base + w, mask);
+                        first = end + 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // word `w` of row(v), for a compressed row
+    inline uint64_t RowWord(int v, int w) const
+    {
+        const uint32_t key = static_cast<uint32_t>(w / kChunkWords);
+        const Container* begin = containers.data() + first_container[v];
+        const Container* end = containers.data() + first_container[v + 1];
+        const Container* c = std::lower_bound(begin, end, key, [](const Container& a, uint32_t k) { return a.key < k; });
+        if (c == end || c->key != key)
+            return 0ULL;
+        const int local = w % kChunkWords;
+        if (c->kind == Kind::Bitmap)
+            return bitmaps[c->offset + local];
+
+        const uint16_t low = static_cast<uint16_t>(local * 64), high = static_cast<uint16_t>(local * 64 + 63);
+        const uint16_t* x = values.data() + c->offset;
+        uint64_t mask = 0;
+        if (c->kind == Kind::Array)
+        {
+            for (const uint16_t* it = std::lower_bound(x, x + c->size, low); it != x + c->size && *it <= high; ++it)
+                mask |= 1ULL << (*it & 63);
+            return mask;
+        }
+        // runs are sorted and disjoint: from the last one starting in or before the word,
+        // back while they still reach into it
+        uint32_t lo = 0, hi = c->size;
+        while (lo < hi)
+        {
+            const uint32_t mid = (lo + hi) / 2;
+            if (x[2 * mid] <= high)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (uint32_t i = lo; i-- > 0;)
+        {
+            const int start = x[2 * i];
+            const int stop = start + x[2 * i + 1];
+            if (stop < low)
+                break;
+            const int first = std::max<int>(start, low) & 63;
+            const int width = std::min<int>(stop, high) - std::max<int>(start, low) + 1;
+            mask |= (width == 64 ? ~0ULL : ((1ULL << width) - 1)) << first;
+        }
+        return mask;
+    }
+
+    int dense_rows = 0;
+    std::vector<int> dense_index;          // row -> index into dense, -1 for compressed rows
+    std::vector<uint64_t, HugePageAllocator<uint64_t>> dense;
+    std::vector<uint32_t> first_container; // row -> its containers, first_container[v]..[v + 1]
+    std::vector<Container> containers;
+    std::vector<uint16_t> values;          // arrays and runs
+    std::vector<uint64_t, HugePageAllocator<uint64_t>> bitmaps;
+};
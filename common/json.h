@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough JSON for configuration files: the whole grammar is accepted, numbers keep the
+// text they were written with, objects keep their members in file order.
+struct JsonValue
+{
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    std::string text; // string contents, or the number as written
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    bool IsScalar() const
+    {
+        return type == Type::Bool || type == Type::Number || type == Type::String;
+    }
+
+    // scalars as a command line would spell them
+    std::string ScalarText() const
+    {
+        if (type == Type::Bool)
+            return boolean ? "true" : "false";
+        return text;
+    }
+
+    const JsonValue* Find(const std::string& key) const
+    {
+        for (const auto& member : members)
+            if (member.first == key) return &member.second;
+        return nullptr;
+    }
+};
+
+class JsonParser
+{
+public:
+    explicit JsonParser(const std::string& text) : text(text) {}
+
+    // on failure `error` says what went wrong and where
+    bool Parse(JsonValue& value, std::string& error)
+    {
+        pos = 0;
+        if (!ParseValue(value, 0) || (SkipSpace(), pos != text.size()))
+        {
+            error = (message.empty() ? std::string("unexpected character") : message) + " at line " +
+                    std::to_string(Line());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    int Line() const
+    {
+        int line = 1;
+        for (size_t i = 0; i < pos && i < text.size(); ++i)
+            if (text[i] == '\n') ++line;
+        return line;
+    }
+
+    void SkipSpace()
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+            ++pos;
+    }
+
+    bool Fail(const char* what)
+    {
+        if (message.empty())
+            message = what;
+        return false;
+    }
+
+    bool Literal(const char* word)
+    {
+        const std::string w = word;
+        if (text.compare(pos, w.size(), w) != 0)
+            return Fail("unknown literal");
+        pos += w.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value, int depth)
+    {
+        if (depth > kMaxDepth)
+            return Fail("nesting too deep");
+        SkipSpace();
+        if (pos >= text.size())
+            return Fail("unexpected end of file");
+        const char c = text[pos];
+        if (c == '{')
+            return ParseObject(value, depth);
+        if (c == '[')
+            return ParseArray(value, depth);
+        if (c == '"')
+        {
+            value.type = JsonValue::Type::String;
+            return ParseString(value.text);
+        }
+        if (c == 't' || c == 'f')
+        {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = c == 't';
+            return Literal(c == 't' ? "true" : "false");
+        }
+        if (c == 'n')
+        {
+            value.type = JsonValue::Type::Null;
+            return Literal("null");
+        }
+        return ParseNumber(value);
+    }
+
+    bool ParseNumber(JsonValue& value)
+    {
+        const size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') ++pos;
+        while (pos < text.size() && (isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.' ||
+                                     text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-'))
+            ++pos;
+        value.type = JsonValue::Type::Number;
+        value.text = text.substr(start, pos - start);
+        char* end = nullptr;
+        std::strtod(value.text.c_str(), &end);
+        if (value.text.empty() || end != value.text.c_str() + value.text.size())
+            return Fail("invalid number");
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, unsigned code)
+    {
+        if (code < 0x80)
+        {
+            out += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool ParseHex4(unsigned& code)
+    {
+        if (pos + 4 > text.size())
+            return Fail("invalid escape");
+        code = static_cast<unsigned>(std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16));
+        pos += 4;
+        return true;
+    }
+
+    bool ParseString(std::string& out)
+    {
+        ++pos; // opening quote
+        out.clear();
+        while (pos < text.size() && text[pos] != '"')
+        {
+            char c = text[pos++];
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size())
+                break;
+            c = text[pos++];
+            switch (c)
+            {
+            case '"': case '\\': case '/': out += c; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                unsigned code = 0;
+                if (!ParseHex4(code))
+                    return false;
+                // a surrogate pair encodes one code point above U+FFFF
+                if (code >= 0xD800 && code < 0xDC00 && text.compare(pos, 2, "\\u") == 0)
+                {
+                    pos += 2;
+                    unsigned low = 0;
+                    if (!ParseHex4(low))
+                        return false;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUtf8(out, code);
+                break;
+            }
+            default:
+                return Fail("invalid escape");
+            }
+        }
+        if (pos >= text.size())
+            return Fail("unterminated string");
+        ++pos; // closing quote
+        return true;
+    }
+
+    bool ParseArray(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::Type::Array;
+        ++pos;
+        SkipSpace();
+        if (pos < text.size() && text[pos] == ']')
+        {
+            ++pos;
+            return true;
+        }
+        while (true)
+        {
+            value.items.emplace_back();
+            if (!ParseValue(value.items.back(), depth + 1))
+                return false;
+            SkipSpace();
+            if (pos < text.size() && text[pos] == ',')
+            {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == ']')
+            {
+                ++pos;
+                return true;
+            }
+            return Fail("expected ',' or ']'");
+        }
+    }
+
+    bool ParseObject(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::Type::Object;
+        ++pos;
+        SkipSpace();
+        if (pos < text.size() && text[pos] == '}')
+        {
+            ++pos;
+            return true;
+        }
+        while (true)
+        {
+            SkipSpace();
+            if (pos >= text.size() || text[pos] != '"')
+                return Fail("expected a member name");
+            std::string key;
+            if (!ParseString(key))
+                return false;
+            SkipSpace();
+            if (pos >= text.size() || text[pos] != ':')
+                return Fail("expected ':'");
+            ++pos;
+            value.members.emplace_back(std::move(key), JsonValue());
+            if (!ParseValue(value.members.back().second, depth + 1))
+                return false;
+            SkipSpace();
+            if (pos < text.size() && text[pos] == ',')
+            {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == '}')
+            {
+                ++pos;
+                return true;
+            }
+            return Fail("expected ',' or '}'");
+        }
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+    std::string message;
+};
+
+// `text` as a JSON string literal, quotes included
+inline std::string JsonQuote(const std::string& text)
+{
+    std::string out = "\"";
+    for (const char c : text)
+    {
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                static const char* hex = "0123456789abcdef";
+                out += "\\u00";
+                out += hex[(c >> 4) & 0xF];
+                out += hex[c & 0xF];
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+    return out + '"';
+}
+
+inline bool ReadJsonFile(const std::string& filename, JsonValue& value)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string error;
+    if (!JsonParser(text).Parse(value, error))
+    {
+        std::cerr << "Error: '" << filename << "': " << error << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "bit_graph.h"
+#include "graph_io.h"
+#include "parallel.h"
+#include "vertex_order.h"
+
+// Bron-Kerbosch with Tomita pivoting over the degeneracy order (Eppstein, Loffler, Strash).
+// Outer vertex v starts the search with P = its later neighbours and X = its earlier ones,
+// so a subproblem never has more than `degeneracy` candidates. Each subproblem is solved on
+// local ids, with bitset P/X sets when the neighbourhood is small or dense and with sorted
+// vectors otherwise. Outer vertices are shared between threads.
+class MaximalCliqueEnumerator
+{
+public:
+    // called for every maximal clique, from the thread that found it
+    using Sink = std::function<void(const std::vector<int>& clique, int thread_id)>;
+
+    // Neighbourhoods up to kSmallSubproblem vertices always use bitsets, larger ones when at
+    // least 1/kDenseRatio of their vertex pairs are adjacent and the bitsets stay reasonable.
+    static constexpr int kSmallSubproblem = 128;
+    static constexpr int kDenseRatio = 16;
+    static constexpr int kMaxDenseSubproblem = 16384;
+
+    explicit MaximalCliqueEnumerator(const CsrGraph& graph)
+        : graph(graph), degeneracy(ComputeDegeneracyOrder(graph))
+    {
+    }
+
+    int Degeneracy() const
+    {
+        return degeneracy.degeneracy;
+    }
+
+    // Returns the number of maximal cliques, isolated vertices included.
+    int64_t Run(int threads, const Sink& sink)
+    {
+        threads = std::max(1, threads);
+        std::vector<Worker> workers;
+        workers.reserve(threads);
+        for (int t = 0; t < threads; ++t) workers.emplace_back(graph.n);
+
+        std::atomic<int64_t> total{0};
+        dense_subproblems = 0;
+        sparse_subproblems = 0;
+        ParallelFor(graph.n, threads, [&](int i, int thread_id)
+        {
+            Worker& worker = workers[thread_id];
+            worker.thread_id = thread_id;
+            worker.sink = &sink;
+            worker.found = 0;
+            SolveOuter(worker, degeneracy.order[i]);
+            total += worker.found;
+        });
+        return total.load();
+    }
+
+    int64_t DenseSubproblems() const { return dense_subproblems.load(); }
+    int64_t SparseSubproblems() const { return sparse_subproblems.load(); }
+
+private:
+    struct Worker
+    {
+        explicit Worker(int n) : local_id(n, -1) {}
+
+        int thread_id = 0;
+        const Sink* sink = nullptr;
+        int64_t found = 0;
+
+        std::vector<int> local_id;   // global vertex -> index in `local`, -1 outside
+        std::vector<int> local;      // neighbourhood of the outer vertex, local id -> global
+        std::vector<int> offsets;    // local adjacency lists, sorted local ids
+        std::vector<int> adjacency;
+        std::vector<uint64_t> rows;  // the same as bitset rows, dense subproblems only
+        int words = 0;
+
+        std::vector<int> clique;     // global ids, the outer vertex first
+        std::vector<std::vector<uint64_t>> bit_levels; // P and X of every depth, dense subproblems
+
+        void Emit()
+        {
+            ++found;
+            (*sink)(clique, thread_id);
+        }
+    };
+
+    void SolveOuter(Worker& w, int v)
+    {
+        const int position = degeneracy.position[v];
+        std::span<const int> neighbours = graph.Neighbours(v);
+        w.clique.assign(1, v);
+        if (neighbours.empty())
+        {
+            w.Emit();
+            return;
+        }
+
+        // local ids follow the sorted neighbour list, so local adjacency lists stay sorted
+        const int s = static_cast<int>(neighbours.size());
+        w.local.assign(neighbours.begin(), neighbours.end());
+        for (int a = 0; a < s; ++a) w.local_id[w.local[a]] = a;
+        w.offsets.assign(1, 0);
+        w.adjacency.clear();
+        for (int a = 0; a < s; ++a)
+        {
+            for (int u : graph.Neighbours(w.local[a]))
+            {
+                const int b = w.local_id[u];
+                if (b >= 0)
+                    w.adjacency.push_back(b);
+            }
+            w.offsets.push_back(static_cast<int>(w.adjacency.size()));
+        }
+        for (int u : w.local) w.local_id[u] = -1;
+
+        const int64_t pairs = static_cast<int64_t>(s) * (s - 1);
+        const bool dense = s <= kSmallSubproblem ||
+                           (s <= kMaxDenseSubproblem && static_cast<int64_t>(w.adjacency.size()) * kDenseRatio >= pairs);
+        if (dense)
+        {
+            ++dense_subproblems;
+            w.words = BitsetWords(s);
+            w.rows.assign(static_cast<size_t>(s) * w.words, 0ULL);
+            for (int a = 0; a < s; ++a)
+                for (int k = w.offsets[a]; k < w.offsets[a + 1]; ++k) SetBit(w.rows.data() + static_cast<size_t>(a) * w.words, w.adjacency[k]);
+
+            uint64_t* p = BitLevel(w, 0);
+            uint64_t* x = p + w.words;
+            std::fill(p, p + 2 * w.words, 0ULL);
+            for (int a = 0; a < s; ++a) SetBit(degeneracy.position[w.local[a]] > position ? p : x, a);
+            ExpandDense(w, 0);
+        }
+        else
+        {
+            ++sparse_subproblems;
+            std::vector<int> p;
+            std::vector<int> x;
+            for (int a = 0; a < s; ++a) (degeneracy.position[w.local[a]] > position ? p : x).push_back(a);
+            ExpandSparse(w, p, x);
+        }
+    }
+
+    // P and X of depth d live side by side in bit_levels[d]
+    uint64_t* BitLevel(Worker& w, int depth)
+    {
+        if (static_cast<int>(w.bit_levels.size()) <= depth)
+            w.bit_levels.resize(depth + 1);
+        std::vector<uint64_t>& level = w.bit_levels[depth];
+        if (level.size() < static_cast<size_t>(2 * w.words))
+            level.resize(2 * w.words);
+        return level.data();
+    }
+
+    const uint64_t* Row(const Worker& w, int a) const
+    {
+        return w.rows.data() + static_cast<size_t>(a) * w.words;
+    }
+
+    void ExpandDense(Worker& w, int depth)
+    {
+        const int words = w.words;
+        uint64_t* p = BitLevel(w, depth);
+        uint64_t* x = p + words;
+        if (IsEmpty(p, words))
+        {
+            if (IsEmpty(x, words))
+                w.Emit();
+            return;
+        }
+
+        // Tomita pivot: the vertex of P or X with the most neighbours in P
+        int pivot = -1;
+        int best = -1;
+        auto consider = [&](int u)
+        {
+            const int c = AndPopCount(Row(w, u), p, words);
+            if (c > best)
+            {
+                best = c;
+                pivot = u;
+            }
+        };
+        ForEachBit(p, words, consider);
+        ForEachBit(x, words, consider);
+
+        const uint64_t* pivot_row = Row(w, pivot);
+        for (int k = 0; k < words; ++k)
+        {
+            // levels keep their buffers once sized, so p and x stay valid across the recursion
+            uint64_t branch = p[k] & ~pivot_row[k];
+            while (branch != 0ULL)
+            {
+                const int v = k * 64 + std::countr_zero(branch);
+                branch &= branch - 1;
+
+                uint64_t* next = BitLevel(w, depth + 1);
+                const uint64_t* row = Row(w, v);
+                for (int j = 0; j < words; ++j)
+                {
+                    next[j] = p[j] & row[j];
+                    next[words + j] = x[j] & row[j];
+                }
+                w.clique.push_back(w.local[v]);
+                ExpandDense(w, depth + 1);
+                w.clique.pop_back();
+
+                ClearBit(p, v);
+                SetBit(x, v);
+            }
+        }
+    }
+
+    std::span<const int> LocalNeighbours(const Worker& w, int a) const
+    {
+        return {w.adjacency.data() + w.offsets[a], w.adjacency.data() + w.offsets[a + 1]};
+    }
+
+    static int IntersectionSize(std::span<const int> a, std::span<const int> b)
+    {
+        int count = 0;
+        for (size_t i = 0, j = 0; i < a.size() && j < b.size();)
+        {
+            if (a[i] < b[j]) ++i;
+            else if (a[i] > b[j]) ++j;
+            else { ++count; ++i; ++j; }
+        }
+        return count;
+    }
+
+    static void Intersect(std::span<const int> a, std::span<const int> b, std::vector<int>& out)
+    {
+        for (size_t i = 0, j = 0; i < a.size() && j < b.size();)
+        {
+            if (a[i] < b[j]) ++i;
+            else if (a[i] > b[j]) ++j;
+            else { out.push_back(a[i]); ++i; ++j; }
+        }
+    }
+
+    // p and x are sorted local ids
+    void ExpandSparse(Worker& w, std::vector<int>& p, std::vector<int>& x)
+    {
+        if (p.empty())
+        {
+            if (x.empty())
+                w.Emit();
+            return;
+        }
+
+        int pivot = -1;
+        int best = -1;
+        for (const std::vector<int>* set : {&p, &x})
+        {
+            for (int u : *set)
+            {
+                const int c = IntersectionSize(LocalNeighbours(w, u), p);
+                if (c > best)
+                {
+                    best = c;
+                    pivot = u;
+                }
+            }
+        }
+
+        std::vector<int> branch;
+        std::span<const int> pivot_neighbours = LocalNeighbours(w, pivot);
+        std::set_difference(p.begin(), p.end(), pivot_neighbours.begin(), pivot_neighbours.end(),
+                            std::back_inserter(branch));
+
+        std::vector<int> next_p;
+        std::vector<int> next_x;
+        for (int v : branch)
+        {
+            std::span<const int> neighbours = LocalNeighbours(w, v);
+            next_p.clear();
+            next_x.clear();
+            Intersect(p, neighbours, next_p);
+            Intersect(x, neighbours, next_x);
+
+            w.clique.push_back(w.local[v]);
+            ExpandSparse(w, next_p, next_x);
+            w.clique.pop_back();
+
+            p.erase(std::lower_bound(p.begin(), p.end(), v));
+            x.insert(std::lower_bound(x.begin(), x.end(), v), v);
+        }
+    }
+
+    const CsrGraph& graph;
+    DegeneracyOrder degeneracy;
+    std::atomic<int64_t> dense_subproblems{0};
+    std::atomic<int64_t> sparse_subproblems{0};
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_graph.h"
+
+// Tightens a coloring bound by MaxSAT reasoning (Li, Quan: MaxCLQ; Li, Fang, Xu: IncMaxCLQ).
+// Every color class is a soft clause "one of these vertices is in the clique" and every
+// non-adjacent pair a hard clause "not both", so a clique satisfies one soft clause per
+// vertex. Unit propagation finds sets of soft clauses that cannot all hold together; each
+// such set, taken disjoint from the others, lowers the bound by one.
+//
+// Branch and bound skips the classes 1..kmin of a node, whose bound is already too low, and
+// branches on every vertex above them. Refine adds those vertices to the skipped part one at
+// a time as singleton soft clauses: a vertex whose clause comes with a new disjoint
+// inconsistent subset keeps the skipped part at bound kmin and needs no branch. Such vertices
+// move in front of the branching ones, whose color bounds stay valid: a clique among them and
+// the skipped part takes at most kmin from the latter and one vertex per higher class.
+//
+// One instance per thread: it keeps scratch buffers between calls. Graph is BitGraph or
+// HybridBitGraph, as for BasicColoringEngine.
+template <class Graph>
+class BasicMaxSatBound
+{
+public:
+    explicit BasicMaxSatBound(const Graph& graph) : graph(&graph) {}
+
+    // order and bounds as ColoringEngine makes them; every position whose bound is at most
+    // kmin can be skipped. Returns how many branching vertices were moved into that part,
+    // which then ends with bound kmin.
+    int Refine(std::vector<int>& order, std::vector<int>& bounds, int kmin)
+    {
+        const int size = static_cast<int>(order.size());
+        int split = 0;
+        while (split < size && bounds[split] <= kmin) ++split;
+        if (kmin <= 0 || split == size)
+            return 0;
+
+        vertices = &order;
+        words = BitsetWords(size);
+        row_ready.assign(size, 0);
+        rows.resize(static_cast<size_t>(size) * words);
+
+        // clauses 0..kmin-1 are the classes, then one per branching vertex tried
+        const int max_clauses = kmin + (size - split);
+        literals.assign(static_cast<size_t>(max_clauses) * words, 0ULL);
+        current.resize(literals.size());
+        active.assign(max_clauses, 0);
+        size_of.assign(max_clauses, 0);
+        count.assign(max_clauses, -1);
+        parents.resize(max_clauses);
+        propagated.assign(max_clauses, 0);
+        touched.clear();
+        for (int p = 0; p < split; ++p)
+        {
+            SetBit(Literals(bounds[p] - 1), p);
+            ++size_of[bounds[p] - 1];
+        }
+        for (int c = 0; c < kmin; ++c) active[c] = 1;
+
+        moved.clear();
+        int next_clause = kmin;
+        for (int p = split; p < size; ++p)
+        {
+            const int c = next_clause++;
+            SetBit(Literals(c), p);
+            size_of[c] = 1;
+            active[c] = 1;
+            if (FindInconsistentSubset(c))
+                moved.push_back(p);
+            else
+                active[c] = 0;
+        }
+        if (moved.empty())
+            return 0;
+
+        new_order.assign(order.begin(), order.begin() + split);
+        new_bounds.assign(bounds.begin(), bounds.begin() + split);
+        is_moved.assign(size, 0);
+        for (int p : moved)
+        {
+            is_moved[p] = 1;
+            new_order.push_back(order[p]);
+            new_bounds.push_back(kmin);
+        }
+        for (int p = split; p < size; ++p)
+        {
+            if (is_moved[p])
+                continue;
+            new_order.push_back(order[p]);
+            new_bounds.push_back(bounds[p]);
+        }
+        order.swap(new_order);
+        bounds.swap(new_bounds);
+        return static_cast<int>(moved.size());
+    }
+
+private:
+    uint64_t* Literals(int clause)
+    {
+        return literals.data() + static_cast<size_t>(clause) * words;
+    }
+
+    uint64_t* Current(int clause)
+    {
+        return current.data() + static_cast<size_t>(clause) * words;
+    }
+
+    // neighbours of position p among the positions of the node, built on first use
+    const uint64_t* LocalRow(int p)
+    {
+        uint64_t* row = rows.data() + static_cast<size_t>(p) * words;
+        if (!row_ready[p])
+        {
+            const std::vector<int>& order = *vertices;
+            for (int w = 0; w < words; ++w) row[w] = 0ULL;
+            for (int q = 0; q < static_cast<int>(order.size()); ++q)
+                if (graph->IsAdjacent(order[p], order[q])) SetBit(row, q);
+            row_ready[p] = 1;
+        }
+        return row;
+    }
+
+    // Unit propagation over the active clauses, starting from `unit`. On a conflict the
+    // clauses that led to it are deactivated and true is returned. Clauses are copied to
+    // `current` only once propagation shrinks them.
+    bool FindInconsistentSubset(int unit)
+    {
+        const int clauses = static_cast<int>(active.size());
+        queue.clear();
+        queue.push_back(unit);
+        for (int c = 0; c < clauses; ++c)
+            if (active[c] && size_of[c] == 1 && c != unit) queue.push_back(c);
+        auto literals_of = [&](int c) { return IsTouched(c) ? Current(c) : Literals(c); };
+
+        bool conflict = false;
+        for (size_t head = 0; head < queue.size() && !conflict; ++head)
+        {
+            const int c = queue[head];
+            if (propagated[c] || (IsTouched(c) ? count[c] : size_of[c]) != 1)
+                continue;
+            Touch(c);
+            propagated[c] = 1;
+            int literal = -1;
+            ForEachBit(Current(c), words, [&](int p) { literal = p; });
+            const uint64_t* row = LocalRow(literal);
+
+            // the literal is in the clique: its non-neighbours are not
+            for (int d = 0; d < clauses; ++d)
+            {
+                if (!active[d] || propagated[d])
+                    continue;
+                const uint64_t* lits = literals_of(d);
+                bool removes = false;
+                for (int w = 0; w < words && !removes; ++w) removes = (lits[w] & ~row[w]) != 0ULL;
+                if (!removes)
+                    continue;
+                Touch(d);
+                uint64_t* kept = Current(d);
+                for (int w = 0; w < words; ++w) kept[w] &= row[w];
+                parents[d].push_back(c);
+                count[d] = PopCount(kept, words);
+                if (count[d] == 0)
+                {
+                    RemoveSubset(d);
+                    conflict = true;
+                    break;
+                }
+                if (count[d] == 1)
+                    queue.push_back(d);
+            }
+        }
+        for (int c : touched)
+        {
+            count[c] = -1;
+            propagated[c] = 0;
+            parents[c].clear();
+        }
+        touched.clear();
+        return conflict;
+    }
+
+    bool IsTouched(int clause) const
+    {
+        return count[clause] >= 0;
+    }
+
+    void Touch(int clause)
+    {
+        if (IsTouched(clause))
+            return;
+        std::copy(Literals(clause), Literals(clause) + words, Current(clause));
+        count[clause] = size_of[clause];
+        touched.push_back(clause);
+    }
+
+    // deactivates the empty clause and every unit clause its emptiness depends on
+    void RemoveSubset(int conflict)
+    {
+        stack.assign(1, conflict);
+        active[conflict] = 0;
+        while (!stack.empty())
+        {
+            const int c = stack.back();
+            stack.pop_back();
+            for (int parent : parents[c])
+            {
+                if (!active[parent])
+                    continue;
+                active[parent] = 0;
+                stack.push_back(parent);
+            }
+        }
+    }
+
+    const Graph* graph;
+    const std::vector<int>* vertices = nullptr;
+    int words = 0;
+    std::vector<char> row_ready;
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> literals; // clause -> its vertices as positions
+    std::vector<uint64_t> current;  // the same during one propagation
+    std::vector<char> active;
+    std::vector<int> size_of; // literals of a clause
+    std::vector<int> count;   // of a touched clause during one propagation, -1 otherwise
+    std::vector<int> touched;
+    std::vector<std::vector<int>> parents; // unit clauses that removed literals of a clause
+    std::vector<char> propagated;
+    std::vector<int> queue;
+    std::vector<int> stack;
+    std::vector<int> moved;
+    std::vector<char> is_moved;
+    std::vector<int> new_order;
+    std::vector<int> new_bounds;
+};
+
+using MaxSatBound = BasicMaxSatBound<BitGraph>;
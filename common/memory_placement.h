@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+// Where large graph storage lives: page size and NUMA node.
+//
+// A dense bitset matrix of 10k+ vertices spans tens of thousands of 4 KB pages, more than
+// the TLB holds, so a row read at random costs a page walk. HugePageAllocator backs arrays
+// of 2 MB and more by huge pages: hugetlbfs pages when the system has some reserved and the
+// policy asks for them, transparent huge pages (madvise) otherwise. Smaller arrays come from
+// the ordinary heap.
+//
+// On a machine with several NUMA nodes, worker threads can be pinned to cores node by node
+// (WorkerPlacement) and given a copy of the read-only rows made by a thread on their own
+// node, which the kernel's first-touch policy places in that node's memory.
+
+enum class HugePages
+{
+    Off,         // 4 KB pages, also where the system would use transparent ones by itself
+    Transparent, // madvise(MADV_HUGEPAGE), the default
+    HugeTlb,     // MAP_HUGETLB, falling back to transparent pages when none are free
+};
+
+inline bool ParseHugePages(const std::string& name, HugePages& mode)
+{
+    if (name == "off")
+        mode = HugePages::Off;
+    else if (name == "thp")
+        mode = HugePages::Transparent;
+    else if (name == "hugetlb")
+        mode = HugePages::HugeTlb;
+    else
+        return false;
+    return true;
+}
+
+inline const char* HugePagesName(HugePages mode)
+{
+    switch (mode)
+    {
+    case HugePages::Off: return "off";
+    case HugePages::Transparent: return "thp";
+    case HugePages::HugeTlb: return "hugetlb";
+    }
+    return "?";
+}
+
+namespace memory_detail
+{
+    constexpr size_t kHugePageBytes = size_t(1) << 21;
+
+    inline std::atomic<HugePages>& Policy()
+    {
+        static std::atomic<HugePages> policy{HugePages::Transparent};
+        return policy;
+    }
+
+    inline size_t RoundUp(size_t bytes)
+    {
+        return (bytes + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+    }
+
+    inline void* AllocateLarge(size_t bytes)
+    {
+#ifdef __linux__
+        const size_t length = RoundUp(bytes);
+        const HugePages policy = Policy().load(std::memory_order_relaxed);
+#ifdef MAP_HUGETLB
+        if (policy == HugePages::HugeTlb)
+        {
+            void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+                return p;
+        }
+#endif
+        // 2 MB aligned, so that every 2 MB of the array can be one huge page
+        void* raw = mmap(nullptr, length + kHugePageBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc();
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t start = (begin + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+        if (start > begin)
+            munmap(raw, start - begin);
+        munmap(reinterpret_cast<void*>(start + length), begin + kHugePageBytes - start);
+        void* p = reinterpret_cast<void*>(start);
+#ifdef MADV_HUGEPAGE
+        madvise(p, length, policy == HugePages::Off ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+        return p;
+#else
+        return ::operator new(bytes);
+#endif
+    }
+
+    inline void FreeLarge(void* p, size_t bytes)
+    {
+#ifdef __linux__
+        munmap(p, RoundUp(bytes));
+#else
+        ::operator delete(p);
+        (void)bytes;
+#endif
+    }
+}
+
+// Applies to the allocations made after the call.
+inline void SetHugePages(HugePages mode)
+{
+    memory_detail::Policy().store(mode, std::memory_order_relaxed);
+}
+
+inline HugePages GetHugePages()
+{
+    return memory_detail::Policy().load(std::memory_order_relaxed);
+}
+
+template <class T>
+struct HugePageAllocator
+{
+    using value_type = T;
+
+    HugePageAllocator() = default;
+
+    template <class U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(size_t count)
+    {
+        const size_t bytes = count * sizeof(T);
+        if (bytes < memory_detail::kHugePageBytes)
+            return static_cast<T*>(::operator new(bytes));
+        return static_cast<T*>(memory_detail::AllocateLarge(bytes));
+    }
+
+    void deallocate(T* p, size_t count)
+    {
+        const size_t bytes = count * sizeof(T);
+        if (bytes < memory_detail::kHugePageBytes)
+            ::operator delete(p);
+        else
+            memory_detail::FreeLarge(p, bytes);
+    }
+
+    template <class U>
+    bool operator==(const HugePageAllocator<U>&) const
+    {
+        return true;
+    }
+};
+
+// Huge page memory of this process in KB: transparent (AnonHugePages) plus hugetlbfs pages
+// mapped by it (Private_Hugetlb), 0 where /proc does not tell.
+inline int64_t HugePageKilobytes()
+{
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string key;
+    int64_t total = 0;
+    while (in >> key)
+    {
+        int64_t kb = 0;
+        if (key == "AnonHugePages:" || key == "Private_Hugetlb:" || key == "Shared_Hugetlb:")
+        {
+            in >> kb;
+            total += kb;
+        }
+        in.ignore(1 << 10, '\n');
+    }
+    return total;
+}
+
+// CPUs per NUMA node from sysfs that this process may run on, nodes without such CPUs left
+// out. One node with every CPU where sysfs has no node directory.
+inline std::vector<std::vector<int>> NumaNodeCpus()
+{
+#ifdef __linux__
+    cpu_set_t allowed;
+    const bool restricted = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto usable = [&](int cpu) { return !restricted || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)); };
+#else
+    auto usable = [](int) { return true; };
+#endif
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0;; ++node)
+    {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in)
+            break;
+        // e.g. "0-3,8-11"
+        std::string list;
+        std::getline(in, list);
+        std::stringstream ranges(list);
+        std::string range;
+        std::vector<int> cpus;
+        while (std::getline(ranges, range, ','))
+        {
+            const size_t dash = range.find('-');
+            const int first = std::atoi(range.c_str());
+            const int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+            for (int cpu = first; cpu <= last; ++cpu)
+                if (usable(cpu)) cpus.push_back(cpu);
+        }
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+    if (nodes.empty())
+    {
+        nodes.emplace_back();
+        const int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu) nodes.back().push_back(cpu);
+    }
+    return nodes;
+}
+
+// Binds the calling thread to one CPU; false where that is not supported or allowed.
+inline bool PinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Worker t goes to node t mod nodes and to the next free CPU there, so that the workers are
+// spread evenly over the nodes and their memory controllers.
+class WorkerPlacement
+{
+public:
+    WorkerPlacement() : nodes(NumaNodeCpus()) {}
+
+    int NodeCount() const
+    {
+        return static_cast<int>(nodes.size());
+    }
+
+    int NodeOf(int worker) const
+    {
+        return worker % NodeCount();
+    }
+
+    int CpuOf(int worker) const
+    {
+        const std::vector<int>& cpus = nodes[NodeOf(worker)];
+        return cpus[(worker / NodeCount()) % cpus.size()];
+    }
+
+    // some CPU of the node, for the thread that builds the node's copy of the graph
+    int CpuOfNode(int node) const
+    {
+        return nodes[node].front();
+    }
+
+private:
+    std::vector<std::vector<int>> nodes;
+};
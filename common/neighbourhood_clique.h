@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "bit_graph.h"
+#include "coloring.h"
+#include "graph_io.h"
+#include "parallel.h"
+#include "vertex_order.h"
+
+// Maximum clique of a large sparse graph without an n x n bitset. Every clique has a vertex
+// that comes first in the degeneracy order, and then lies within that vertex and its later
+// neighbours, at most `degeneracy` of them. So the search splits into one subproblem per
+// vertex, each a small dense graph that gets local ids, its own bitset rows and a coloring
+// B&B. Memory is the CSR graph plus O(d^2) per thread.
+//
+// Subproblems run from the end of the order, where the dense core is, so that large cliques
+// are found first. A vertex whose core number is below the incumbent size cannot be in a
+// larger clique; such vertices are left out of every subproblem, and a subproblem whose
+// remaining neighbours cannot beat the incumbent is skipped as a whole. Threads take
+// subproblems in order and share the incumbent. As in the bitset B&B, ties go to the clique
+// of the earlier subproblem, so the result does not depend on the thread count.
+class NeighbourhoodCliqueSolver
+{
+public:
+    explicit NeighbourhoodCliqueSolver(const CsrGraph& graph)
+        : graph(graph), degeneracy(ComputeDegeneracyOrder(graph)), core(graph.n, 0), color(graph.n, 0)
+    {
+        // core number: the largest later-neighbour count up to a vertex's position
+        int running = 0;
+        for (int i = 0; i < graph.n; ++i)
+        {
+            const int v = degeneracy.order[i];
+            int later = 0;
+            for (int u : graph.Neighbours(v)) later += degeneracy.position[u] > i;
+            running = std::max(running, later);
+            core[v] = running;
+        }
+
+        // smallest-last coloring: first fit from the end of the order, at most d + 1 colors
+        std::vector<int> used;
+        for (int i = graph.n - 1; i >= 0; --i)
+        {
+            const int v = degeneracy.order[i];
+            used.clear();
+            for (int u : graph.Neighbours(v))
+                if (degeneracy.position[u] > i) used.push_back(color[u]);
+            std::sort(used.begin(), used.end());
+            int c = 0;
+            for (int x : used)
+            {
+                if (x == c)
+                    ++c;
+                else if (x > c)
+                    break;
+            }
+            color[v] = c;
+            color_count = std::max(color_count, c + 1);
+        }
+    }
+
+    int Degeneracy() const
+    {
+        return degeneracy.degeneracy;
+    }
+
+    // The search stops `seconds` after Run starts (0: no limit), see TimedOut.
+    void SetTimeLimit(double seconds)
+    {
+        time_limit = seconds;
+    }
+
+    // Returns a maximum clique, or the largest found within the time limit.
+    std::vector<int> Run(int threads, ColoringStrategy strategy)
+    {
+        best_key = 0;
+        best_clique.clear();
+        solved = 0;
+        skipped = 0;
+        timed_out = false;
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_limit));
+
+        std::vector<Worker> workers(std::max(1, threads));
+        GreedyLowerBound();
+        ParallelFor(graph.n, threads, [&](int rank, int thread_id)
+        {
+            if (timed_out.load(std::memory_order_relaxed))
+                return;
+            Worker& w = workers[thread_id];
+            w.strategy = strategy;
+            w.rank = static_cast<uint32_t>(rank);
+            SolveOuter(w, degeneracy.order[graph.n - 1 - rank]);
+        });
+        std::lock_guard<std::mutex> lock(best_mutex);
+        return best_clique;
+    }
+
+    bool TimedOut() const
+    {
+        return timed_out.load();
+    }
+
+    int64_t SolvedSubproblems() const { return solved.load(); }
+    int64_t SkippedSubproblems() const { return skipped.load(); }
+
+private:
+    static constexpr uint64_t kPollInterval = 1024;
+
+    struct Worker
+    {
+        ColoringStrategy strategy = ColoringStrategy::SequentialGreedy;
+        uint32_t rank = 0;
+        uint64_t nodes = 0;
+        std::vector<int> local;    // local id -> global vertex
+        std::vector<int> local_id; // global vertex -> local id, -1 outside
+        BitGraph rows;
+        std::vector<int> clique; // global ids, the outer vertex first
+        std::vector<char> color_seen;
+    };
+
+    // as in BnBSolver: a larger key is a better clique, ties go to the earlier subproblem
+    static uint64_t PackKey(int size, uint32_t rank)
+    {
+        return (static_cast<uint64_t>(size) << 32) | static_cast<uint64_t>(~rank);
+    }
+
+    bool Beats(int size, uint32_t rank) const
+    {
+        return PackKey(size, rank) > best_key.load(std::memory_order_relaxed);
+    }
+
+    // A first incumbent, so that the core and coloring bounds prune from the start: per vertex
+    // a greedy clique over its later neighbours by decreasing core number. Stored under the
+    // rank of that vertex's subproblem, so the result stays the same.
+    void GreedyLowerBound()
+    {
+        std::vector<int> later;
+        std::vector<int> clique;
+        for (int rank = 0; rank < graph.n; ++rank)
+        {
+            const int v = degeneracy.order[graph.n - 1 - rank];
+            if (!Beats(core[v] + 1, rank))
+                continue;
+            later.clear();
+            for (int u : graph.Neighbours(v))
+                if (degeneracy.position[u] > degeneracy.position[v]) later.push_back(u);
+            std::sort(later.begin(), later.end(), [&](int a, int b) { return core[a] > core[b]; });
+            clique.assign(1, v);
+            for (int u : later)
+            {
+                bool adjacent = true;
+                for (size_t k = 1; k < clique.size() && adjacent; ++k) adjacent = graph.HasEdge(u, clique[k]);
+                if (adjacent)
+                    clique.push_back(u);
+            }
+            if (Beats(static_cast<int>(clique.size()), rank))
+            {
+                best_key = PackKey(static_cast<int>(clique.size()), rank);
+                best_clique = clique;
+            }
+        }
+    }
+
+    void SolveOuter(Worker& w, int v)
+    {
+        const int position = degeneracy.position[v];
+        if (!Beats(core[v] + 1, w.rank))
+        {
+            ++skipped;
+            return;
+        }
+
+        // later neighbours that may still be in a better clique
+        w.local.clear();
+        for (int u : graph.Neighbours(v))
+            if (degeneracy.position[u] > position && Beats(core[u] + 1, w.rank)) w.local.push_back(u);
+        const int s = static_cast<int>(w.local.size());
+        if (!Beats(s + 1, w.rank) || !Beats(DistinctColors(w, v), w.rank))
+        {
+            ++skipped;
+            return;
+        }
+        ++solved;
+
+        w.rows = BitGraph(s);
+        w.local_id.resize(graph.n, -1);
+        for (int a = 0; a < s; ++a) w.local_id[w.local[a]] = a;
+        for (int a = 0; a < s; ++a)
+        {
+            for (int u : graph.Neighbours(w.local[a]))
+            {
+                const int b = w.local_id[u];
+                if (b >= 0)
+                    SetBit(w.rows.Row(a), b);
+            }
+        }
+        for (int u : w.local) w.local_id[u] = -1;
+
+        // greedy coloring visits them by decreasing local degree, as at the B&B root
+        ColoringEngine coloring(w.rows);
+        std::vector<int> candidates(s);
+        std::vector<int> local_degree(s);
+        for (int a = 0; a < s; ++a)
+        {
+            candidates[a] = a;
+            local_degree[a] = PopCount(w.rows.Row(a), w.rows.words);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [&](int a, int b) { return local_degree[a] > local_degree[b]; });
+        w.clique.assign(1, v);
+        Expand(w, coloring, candidates);
+    }
+
+    // colors of the outer vertex and its local neighbours, a bound on their clique number
+    int DistinctColors(Worker& w, int v) const
+    {
+        w.color_seen.assign(color_count, 0);
+        int distinct = 0;
+        w.color_seen[color[v]] = 1;
+        ++distinct;
+        for (int u : w.local)
+        {
+            distinct += !w.color_seen[color[u]];
+            w.color_seen[color[u]] = 1;
+        }
+        return distinct;
+    }
+
+    void Expand(Worker& w, ColoringEngine& coloring, const std::vector<int>& candidates)
+    {
+        if (++w.nodes % kPollInterval == 0 && time_limit > 0.0 && std::chrono::steady_clock::now() >= deadline)
+            timed_out = true;
+        if (timed_out.load(std::memory_order_relaxed))
+            return;
+        if (candidates.empty())
+        {
+            Store(w);
+            return;
+        }
+
+        std::vector<int> order;
+        std::vector<int> bounds;
+        coloring.Color(w.strategy, candidates, order, bounds);
+        const int size = static_cast<int>(w.clique.size());
+        std::vector<int> next;
+        for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i)
+        {
+            if (!Beats(size + bounds[i], w.rank))
+                return; // bounds are nondecreasing
+            const uint64_t* row = w.rows.Row(order[i]);
+            next.clear();
+            for (int j = 0; j < i; ++j)
+                if (TestBit(row, order[j])) next.push_back(order[j]);
+            w.clique.push_back(w.local[order[i]]);
+            Expand(w, coloring, next);
+            w.clique.pop_back();
+        }
+    }
+
+    void Store(const Worker& w)
+    {
+        const uint64_t key = PackKey(static_cast<int>(w.clique.size()), w.rank);
+        std::lock_guard<std::mutex> lock(best_mutex);
+        if (key <= best_key.load())
+            return;
+        best_key = key;
+        best_clique = w.clique;
+    }
+
+    const CsrGraph& graph;
+    DegeneracyOrder degeneracy;
+    std::vector<int> core;
+    std::vector<int> color; // a proper coloring of the whole graph
+    int color_count = 0;
+    double time_limit = 0.0;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> timed_out{false};
+    std::atomic<uint64_t> best_key{0};
+    std::mutex best_mutex;
+    std::vector<int> best_clique;
+    std::atomic<int64_t> solved{0};
+    std::atomic<int64_t> skipped{0};
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+inline int DefaultThreadCount()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Runs task(i) for every i in [0, tasks) on up to `threads` threads, which claim tasks in
+// increasing order. task(i, thread_id) is also accepted, for per-thread scratch state.
+template <class Task>
+void ParallelFor(int tasks, int threads, Task&& task)
+{
+    threads = std::max(1, std::min(threads, tasks));
+    auto run = [&](int thread_id, std::atomic<int>* next)
+    {
+        for (int i = next ? (*next)++ : 0; i < tasks; i = next ? (*next)++ : i + 1)
+        {
+            if constexpr (std::is_invocable_v<Task&, int, int>)
+                task(i, thread_id);
+            else
+                task(i);
+        }
+    };
+    if (threads == 1)
+    {
+        run(0, nullptr);
+        return;
+    }
+
+    std::atomic<int> next{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back(run, t, &next);
+    for (std::thread& w : workers)
+        w.join();
+}
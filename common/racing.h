@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parallel.h"
+#include "random.h"
+
+// Offline parameter tuning by iterated racing (Birattari et al., F-race; Lopez-Ibanez et al.,
+// irace). A race runs every surviving configuration on one instance and seed after another;
+// once enough of these blocks are in, a Friedman test on the ranks inside each block drops
+// the configurations that are significantly worse than the best one. Each iteration races
+// the elites of the previous one against new configurations sampled around them.
+
+// A tuned parameter: an integer or real range, sampled uniformly or on a log scale.
+struct TuneParameter
+{
+    std::string name;
+    bool integer = true;
+    double low = 0.0;
+    double high = 0.0;
+    bool log_scale = false;
+};
+
+// parameter name -> value, spelled as the driver's command line options take it
+using TuneConfig = std::map<std::string, std::string>;
+
+struct RaceSettings
+{
+    int threads = 1;
+    double budget_sec = 60.0;  // wall time of the whole tuning run
+    int iterations = 3;        // racing iterations
+    int configurations = 12;   // configurations per race, elites included
+    int elites = 3;            // survivors carried to the next iteration
+    int first_test = 4;        // blocks before the first elimination test
+    int max_blocks = 40;       // blocks per race at most
+    uint64_t seed = kDefaultSeed;
+};
+
+// cost of one run, lower is better; called concurrently for different configurations
+using RaceEvaluator = std::function<double(const TuneConfig& config, int instance, uint64_t seed)>;
+
+class IteratedRace
+{
+public:
+    IteratedRace(std::vector<TuneParameter> parameters, RaceSettings settings)
+        : parameters(std::move(parameters)), settings(settings), rng(DeriveSeed(settings.seed, 0))
+    {
+    }
+
+    // Tunes over `instances` instances starting from `initial` (usually the hand-picked
+    // defaults) and returns the best configuration found with its mean cost.
+    TuneConfig Run(const TuneConfig& initial, int instances, const RaceEvaluator& evaluate, double& best_cost,
+                   std::ostream* log = nullptr)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<TuneConfig> elites(1, initial);
+        std::vector<double> elite_costs(1, 0.0);
+        for (int iteration = 0; iteration < settings.iterations; ++iteration)
+        {
+            const double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const double budget = (settings.budget_sec - spent) / (settings.iterations - iteration);
+            if (budget <= 0.0)
+                break;
+
+            // the spread of new samples shrinks with every iteration, as in irace
+            const double spread = 0.5 * std::pow(0.6, iteration);
+            std::vector<TuneConfig> candidates = elites;
+            while (static_cast<int>(candidates.size()) < settings.configurations)
+            {
+                const TuneConfig& parent = elites[Bounded(rng, static_cast<uint32_t>(elites.size()))];
+                candidates.push_back(iteration == 0 ? Sample() : Perturb(parent, spread));
+            }
+
+            std::vector<double> costs;
+            std::vector<int> order = Race(candidates, instances, budget, iteration, evaluate, costs);
+            elites.clear();
+            elite_costs.clear();
+            for (int i = 0; i < static_cast<int>(order.size()) && i < settings.elites; ++i)
+            {
+                elites.push_back(candidates[order[i]]);
+                elite_costs.push_back(costs[order[i]]);
+            }
+            if (log != nullptr)
+                *log << "  iteration " << iteration + 1 << ": " << order.size() << " of " << candidates.size()
+                     << " survived, best mean cost " << std::fixed << std::setprecision(4) << elite_costs[0]
+                     << " with " << Describe(elites[0]) << '\n';
+        }
+        best_cost = elite_costs[0];
+        return elites[0];
+    }
+
+    static std::string Describe(const TuneConfig& config)
+    {
+        std::string text;
+        for (const auto& [name, value] : config) text += (text.empty() ? "" : " ") + name + "=" + value;
+        return text;
+    }
+
+private:
+    double Uniform01()
+    {
+        return (static_cast<double>(Next32(rng)) + 0.5) / 4294967296.0;
+    }
+
+    double Normal()
+    {
+        return std::sqrt(-2.0 * std::log(Uniform01())) * std::cos(6.283185307179586 * Uniform01());
+    }
+
+    // position of a value in [0, 1] on the parameter's scale, and back
+    static double ToUnit(const TuneParameter& p, double value)
+    {
+        if (p.high <= p.low)
+            return 0.0;
+        if (p.log_scale)
+            return (std::log(value) - std::log(p.low)) / (std::log(p.high) - std::log(p.low));
+        return (value - p.low) / (p.high - p.low);
+    }
+
+    static std::string FromUnit(const TuneParameter& p, double unit)
+    {
+        unit = std::clamp(unit, 0.0, 1.0);
+        double value = p.log_scale ? std::exp(std::log(p.low) + unit * (std::log(p.high) - std::log(p.low)))
+                                   : p.low + unit * (p.high - p.low);
+        std::ostringstream text;
+        if (p.integer)
+            text << static_cast<long long>(std::llround(std::clamp(value, p.low, p.high)));
+        else
+            text << std::setprecision(4) << value;
+        return text.str();
+    }
+
+    TuneConfig Sample()
+    {
+        TuneConfig config;
+        for (const TuneParameter& p : parameters) config[p.name] = FromUnit(p, Uniform01());
+        return config;
+    }
+
+    TuneConfig Perturb(const TuneConfig& parent, double spread)
+    {
+        TuneConfig config = parent;
+        for (const TuneParameter& p : parameters)
+        {
+            auto it = parent.find(p.name);
+            const double unit = it == parent.end() ? Uniform01() : ToUnit(p, std::atof(it->second.c_str()));
+            config[p.name] = FromUnit(p, unit + spread * Normal());
+        }
+        return config;
+    }
+
+    // ranks of one block, 1 for the lowest cost, ties get their mean rank
+    static void RankBlock(const std::vector<double>& costs, std::vector<double>& ranks)
+    {
+        const int k = static_cast<int>(costs.size());
+        std::vector<int> index(k);
+        for (int i = 0; i < k; ++i) index[i] = i;
+        std::sort(index.begin(), index.end(), [&](int a, int b) { return costs[a] < costs[b]; });
+        ranks.assign(k, 0.0);
+        for (int i = 0; i < k;)
+        {
+            int j = i;
+            while (j < k && costs[index[j]] == costs[index[i]]) ++j;
+            for (int t = i; t < j; ++t) ranks[index[t]] = 0.5 * (i + 1 + j);
+            i = j;
+        }
+    }
+
+    // upper quantiles at alpha = 0.05: chi-square by Wilson-Hilferty, Student t by its
+    // first Cornish-Fisher correction
+    static double ChiSquareQuantile(double df)
+    {
+        const double z = 1.6448536;
+        const double a = 2.0 / (9.0 * df);
+        return df * std::pow(1.0 - a + z * std::sqrt(a), 3.0);
+    }
+
+    static double StudentQuantile(double df)
+    {
+        const double z = 1.9599640; // two-sided
+        return z + (z * z * z + z) / (4.0 * df);
+    }
+
+    // Runs the race and returns the surviving candidates, best mean rank first, with the
+    // mean cost of every candidate in `costs`.
+    std::vector<int> Race(const std::vector<TuneConfig>& candidates, int instances, double budget, int iteration,
+                          const RaceEvaluator& evaluate, std::vector<double>& costs)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const int total = static_cast<int>(candidates.size());
+        std::vector<int> alive(total);
+        for (int c = 0; c < total; ++c) alive[c] = c;
+        std::vector<std::vector<double>> results(total);
+
+        int blocks = 0;
+        while (alive.size() > 1 && blocks < settings.max_blocks)
+        {
+            const double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (blocks > 0 && spent >= budget)
+                break;
+
+            // every candidate of a block runs the same instance with the same seed
+            const int instance = blocks % instances;
+            const uint64_t seed = DeriveSeed(DeriveSeed(settings.seed, 1 + iteration), blocks);
+            std::vector<double> block(alive.size());
+            ParallelFor(static_cast<int>(alive.size()), settings.threads,
+                        [&](int i) { block[i] = evaluate(candidates[alive[i]], instance, seed); });
+            for (size_t i = 0; i < alive.size(); ++i) results[alive[i]].push_back(block[i]);
+            ++blocks;
+
+            if (blocks >= settings.first_test)
+                Eliminate(alive, results, blocks);
+        }
+
+        costs.assign(total, 0.0);
+        for (int c = 0; c < total; ++c)
+        {
+            for (double cost : results[c]) costs[c] += cost;
+            if (!results[c].empty())
+                costs[c] /= static_cast<double>(results[c].size());
+        }
+        std::vector<double> rank_sums = RankSums(alive, results, blocks);
+        std::vector<int> order(alive.size());
+        for (size_t i = 0; i < alive.size(); ++i) order[i] = static_cast<int>(i);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return rank_sums[a] < rank_sums[b]; });
+        for (int& i : order) i = alive[i];
+        return order;
+    }
+
+    // rank sums over the last `blocks` blocks, which every alive candidate has run
+    static std::vector<double> RankSums(const std::vector<int>& alive, const std::vector<std::vector<double>>& results,
+                                        int blocks, double* squares = nullptr)
+    {
+        std::vector<double> sums(alive.size(), 0.0);
+        std::vector<double> block(alive.size());
+        std::vector<double> ranks;
+        if (squares != nullptr)
+            *squares = 0.0;
+        for (int b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < alive.size(); ++i) block[i] = results[alive[i]][b];
+            RankBlock(block, ranks);
+            for (size_t i = 0; i < alive.size(); ++i)
+            {
+                sums[i] += ranks[i];
+                if (squares != nullptr)
+                    *squares += ranks[i] * ranks[i];
+            }
+        }
+        return sums;
+    }
+
+    // Friedman test over the blocks so far; if the candidates differ, keep only the ones
+    // whose rank sum is within the Conover critical difference of the best.
+    static void Eliminate(std::vector<int>& alive, const std::vector<std::vector<double>>& results, int blocks)
+    {
+        const double k = static_cast<double>(alive.size());
+        const double b = static_cast<double>(blocks);
+        double a = 0.0;
+        std::vector<double> sums = RankSums(alive, results, blocks, &a);
+        const double c = b * k * (k + 1.0) * (k + 1.0) / 4.0;
+        if (a - c <= 1e-12)
+            return; // all ties
+        double spread = 0.0;
+        for (double r : sums) spread += (r - b * (k + 1.0) / 2.0) * (r - b * (k + 1.0) / 2.0);
+        const double t = (k - 1.0) * spread / (a - c);
+        if (t <= ChiSquareQuantile(k - 1.0))
+            return;
+
+        const double df = (b - 1.0) * (k - 1.0);
+        const double difference = StudentQuantile(df) *
+                                  std::sqrt(2.0 * b * (a - c) / df * std::max(0.0, 1.0 - t / (b * (k - 1.0))));
+        const double best = *std::min_element(sums.begin(), sums.end());
+        std::vector<int> survivors;
+        for (size_t i = 0; i < alive.size(); ++i)
+            if (sums[i] - best <= difference) survivors.push_back(alive[i]);
+        alive = survivors;
+    }
+
+    std::vector<TuneParameter> parameters;
+    RaceSettings settings;
+    Xoshiro256pp rng;
+};
+
+// Family of a DIMACS instance: its file name up to the first digit, "brock" for
+// brock200_1.clq, "p_hat" for p_hat300-3.clq; the whole name if it starts with a digit.
+inline std::string InstanceFamily(const std::string& file_name)
+{
+    std::string stem = file_name.substr(0, file_name.find('.'));
+    const size_t digit = stem.find_first_of("0123456789");
+    return digit == 0 || digit == std::string::npos ? stem : stem.substr(0, digit);
+}
+
+// Races the parameters separately on every instance family of `names` and returns the winner
+// of each. The budget of `settings` is shared out by the number of instances of a family.
+// initial(i) is the starting configuration for instance i, evaluate(config, i, seed) the cost
+// of one run on instance i.
+inline std::map<std::string, TuneConfig> TuneByFamily(
+    const std::vector<std::string>& names, const std::vector<TuneParameter>& parameters, const RaceSettings& settings,
+    const std::function<TuneConfig(int)>& initial,
+    const std::function<double(const TuneConfig&, int, uint64_t)>& evaluate, std::ostream* log = nullptr)
+{
+    std::map<std::string, std::vector<int>> families;
+    for (size_t i = 0; i < names.size(); ++i) families[InstanceFamily(names[i])].push_back(static_cast<int>(i));
+
+    std::map<std::string, TuneConfig> tuned;
+    for (const auto& [family, members] : families)
+    {
+        RaceSettings family_settings = settings;
+        family_settings.budget_sec = settings.budget_sec * members.size() / names.size();
+        family_settings.seed = DeriveSeed(settings.seed, tuned.size());
+        if (log != nullptr)
+            *log << "Family " << family << "* (" << members.size() << " instances, " << std::fixed
+                 << std::setprecision(1) << family_settings.budget_sec << " s)\n";
+        double cost = 0.0;
+        tuned[family] = IteratedRace(parameters, family_settings)
+                            .Run(initial(members[0]), static_cast<int>(members.size()),
+                                 [&](const TuneConfig& config, int instance, uint64_t seed)
+                                 { return evaluate(config, members[instance], seed); },
+                                 cost, log);
+    }
+    return tuned;
+}
+
+// Writes the tuned configurations as a --config file: one "instances" entry per family,
+// shorter patterns first so that "sanr*" wins over "san*" for the instances both match.
+inline bool WriteTunedConfig(const std::string& path, const std::map<std::string, TuneConfig>& families)
+{
+    std::vector<std::string> names;
+    for (const auto& family : families) names.push_back(family.first);
+    std::stable_sort(names.begin(), names.end(),
+                     [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
+
+    auto number = [](const std::string& text)
+    {
+        char* end = nullptr;
+        std::strtod(text.c_str(), &end);
+        return !text.empty() && end == text.c_str() + text.size();
+    };
+    std::ofstream out(path);
+    out << "{\n    \"instances\": {\n";
+    for (size_t f = 0; f < names.size(); ++f)
+    {
+        out << "        \"" << names[f] << "*\": {";
+        bool first = true;
+        for (const auto& [name, value] : families.at(names[f]))
+        {
+            out << (first ? "" : ", ") << '"' << name << "\": " << (number(value) ? value : '"' + value + '"');
+            first = false;
+        }
+        out << '}' << (f + 1 < names.size() ? "," : "") << '\n';
+    }
+    out << "    }\n}\n";
+    return static_cast<bool>(out);
+}
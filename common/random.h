@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// All solvers are seeded from a single 64-bit run seed. Independent streams
+// (one per restart, thread or iteration) are derived from it, so the same
+// seed always reproduces the same run.
+constexpr uint64_t kDefaultSeed = 1234567;
+
+inline uint64_t SplitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// seed of stream `stream` of the run started with `seed`
+inline uint64_t DeriveSeed(uint64_t seed, uint64_t stream)
+{
+    uint64_t state = seed ^ (0xD1B54A32D192ED03ULL * (stream + 1));
+    return SplitMix64(state);
+}
+
+// xoshiro256++ (Blackman, Vigna): 256-bit state, very fast, passes BigCrush.
+// Satisfies UniformRandomBitGenerator, so it also works with <random> distributions.
+class Xoshiro256pp
+{
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256pp(uint64_t seed = kDefaultSeed)
+    {
+        this->seed(seed);
+    }
+
+    void seed(uint64_t seed)
+    {
+        for (uint64_t& word : s)
+            word = SplitMix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()()
+    {
+        const uint64_t result = Rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+        return result;
+    }
+
+    // the next `count` outputs, with the state kept in registers for the whole loop
+    void Fill(uint64_t* out, size_t count)
+    {
+        uint64_t s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3];
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = Rotl(s0 + s3, 23) + s0;
+            const uint64_t t = s1 << 17;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = Rotl(s3, 45);
+        }
+        s[0] = s0; s[1] = s1; s[2] = s2; s[3] = s3;
+    }
+
+private:
+    static inline uint64_t Rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s[4];
+};
+
+// PCG32 (O'Neill), XSH-RR output: 64-bit state, 32-bit output.
+class Pcg32
+{
+public:
+    using result_type = uint32_t;
+
+    explicit Pcg32(uint64_t seed = kDefaultSeed)
+    {
+        this->seed(seed);
+    }
+
+    void seed(uint64_t seed)
+    {
+        state = 0;
+        inc = (DeriveSeed(seed, 0) << 1) | 1;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()()
+    {
+        const uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        const uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    void Fill(uint32_t* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = (*this)();
+    }
+
+private:
+    uint64_t state;
+    uint64_t inc;
+};
+
+// Serves outputs of Rng from a buffer refilled Size values at a time, which keeps the
+// generator state out of the caller's hot loop. Rng must provide Fill().
+template <class Rng, size_t Size = 256>
+class BatchedRng
+{
+public:
+    using result_type = typename Rng::result_type;
+
+    explicit BatchedRng(uint64_t seed = kDefaultSeed) : rng(seed) {}
+
+    void seed(uint64_t seed)
+    {
+        rng.seed(seed);
+        pos = Size;
+    }
+
+    static constexpr result_type min() { return Rng::min(); }
+    static constexpr result_type max() { return Rng::max(); }
+
+    result_type operator()()
+    {
+        if (pos == Size)
+        {
+            rng.Fill(buffer, Size);
+            pos = 0;
+        }
+        return buffer[pos++];
+    }
+
+private:
+    Rng rng;
+    result_type buffer[Size];
+    size_t pos = Size;
+};
+
+// Engines accepted here, and as the Rng parameter of the solvers, are 32- or
+// 64-bit full-range engines constructible from a 64-bit seed, such as
+// Xoshiro256pp, Pcg32 or std::mt19937; std::minstd_rand or std::ranlux24 do not compile.
+template <class Rng>
+inline uint32_t Next32(Rng& rng)
+{
+    static_assert(Rng::min() == 0 && (Rng::max() == 0xFFFFFFFFULL || Rng::max() == ~0ULL),
+                  "Next32 needs a generator with full 32-bit or 64-bit output");
+    if constexpr (Rng::max() > 0xFFFFFFFFULL)
+        return static_cast<uint32_t>(rng() >> 32); // high bits are the strongest ones
+    else
+        return static_cast<uint32_t>(rng());
+}
+
+// Unbiased integer in [0, range) without division in the common case
+// (Lemire, "Fast Random Integer Generation in an Interval", 2019).
+template <class Rng>
+inline uint32_t Bounded(Rng& rng, uint32_t range)
+{
+    uint64_t m = static_cast<uint64_t>(Next32(rng)) * range;
+    uint32_t low = static_cast<uint32_t>(m);
+    if (low < range)
+    {
+        const uint32_t threshold = -range % range;
+        while (low < threshold)
+        {
+            m = static_cast<uint64_t>(Next32(rng)) * range;
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+// uniform integer in [a, b]
+template <class Rng>
+inline int UniformInt(Rng& rng, int a, int b)
+{
+    return a + static_cast<int>(Bounded(rng, static_cast<uint32_t>(b - a) + 1));
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "json.h"
+#include "run_options.h"
+#include "timing.h"
+
+// Every solved instance is appended as one JSON line to --results-log, so that runs of
+// different builds, seeds and thread counts can be compared later (tools/compare-results).
+// The build identity comes from common/build_info.cmake.
+
+#ifndef CLIQUE_GIT_HASH
+#define CLIQUE_GIT_HASH "unknown"
+#endif
+#ifndef CLIQUE_BUILD_FLAGS
+#define CLIQUE_BUILD_FLAGS "unknown"
+#endif
+
+struct RunRecord
+{
+    std::string run;        // one id per process, see RunId
+    std::string tag;
+    std::string time;       // UTC, ISO 8601
+    std::string program;
+    std::string instance;
+    std::string git;
+    std::string flags;
+    uint64_t seed = 0;
+    int threads = 1;
+    bool deterministic = false;
+    double parse_sec = 0.0; // wall time of reading and preparing the graph
+    double wall_sec = 0.0;  // of the solve phase, like cpu_sec
+    double cpu_sec = 0.0;
+    long peak_rss_kb = 0;   // of the process since the instance started, see ResetPeakRss
+    int64_t size = 0;       // clique size or weight, number of colours
+    bool minimize = false;  // whether a smaller size is better
+};
+
+// start time and pid: unique per process and sorted by start time
+inline const std::string& RunId()
+{
+    static const std::string id = []
+    {
+        const std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", std::gmtime(&now));
+        return std::string(stamp) + "-" + std::to_string(getpid());
+    }();
+    return id;
+}
+
+// A record for one instance of this run with the usage of its parse and solve phases.
+inline RunRecord MakeRunRecord(const RunOptions& options, const std::string& program, const std::string& instance,
+                               const ResourceUsage& parse, const ResourceUsage& solve, int64_t size,
+                               bool minimize = false)
+{
+    RunRecord record;
+    record.run = RunId();
+    record.tag = options.tag;
+    const std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    record.time = stamp;
+    record.program = program;
+    record.instance = instance;
+    record.git = CLIQUE_GIT_HASH;
+    record.flags = CLIQUE_BUILD_FLAGS;
+    record.seed = options.seed;
+    record.threads = options.threads;
+    record.deterministic = options.deterministic;
+    record.parse_sec = parse.wall_sec;
+    record.wall_sec = solve.wall_sec;
+    record.cpu_sec = solve.cpu_sec;
+    record.peak_rss_kb = solve.peak_rss_kb;
+    record.size = size;
+    record.minimize = minimize;
+    return record;
+}
+
+inline bool AppendRunRecord(const RunOptions& options, const RunRecord& record)
+{
+    if (options.results_log.empty())
+        return true;
+    std::ostringstream line;
+    line.precision(9);
+    line << "{\"run\": " << JsonQuote(record.run) << ", \"tag\": " << JsonQuote(record.tag)
+         << ", \"time\": " << JsonQuote(record.time) << ", \"program\": " << JsonQuote(record.program)
+         << ", \"instance\": " << JsonQuote(record.instance) << ", \"git\": " << JsonQuote(record.git)
+         << ", \"flags\": " << JsonQuote(record.flags) << ", \"seed\": " << record.seed
+         << ", \"threads\": " << record.threads << ", \"deterministic\": " << (record.deterministic ? "true" : "false")
+         << ", \"parse_sec\": " << record.parse_sec << ", \"wall_sec\": " << record.wall_sec
+         << ", \"cpu_sec\": " << record.cpu_sec << ", \"peak_rss_kb\": " << record.peak_rss_kb << ", \"size\": " << record.size
+         << ", \"minimize\": " << (record.minimize ? "true" : "false") << "}\n";
+
+    // one write per record keeps lines whole when several drivers append at once
+    std::ofstream out(options.results_log, std::ios::app | std::ios::binary);
+    out << line.str() << std::flush;
+    if (!out)
+    {
+        std::cerr << "Warning: Cannot append to results log '" << options.results_log << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Reads a results log; lines that do not parse are reported and skipped.
+inline bool ReadRunRecords(const std::string& filename, std::vector<RunRecord>& records)
+{
+    std::ifstream in(filename);
+    if (!in.is_open())
+    {
+        std::cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number)
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        JsonValue value;
+        std::string error;
+        if (!JsonParser(line).Parse(value, error) || value.type != JsonValue::Type::Object)
+        {
+            std::cerr << "Warning: '" << filename << "' line " << number << ": " << (error.empty() ? "not an object" : error)
+                      << '\n';
+            continue;
+        }
+        auto text = [&](const char* key)
+        {
+            const JsonValue* member = value.Find(key);
+            return member != nullptr && member->IsScalar() ? member->ScalarText() : std::string();
+        };
+        auto number_of = [&](const char* key) { return std::strtod(text(key).c_str(), nullptr); };
+
+        RunRecord record;
+        record.run = text("run");
+        record.tag = text("tag");
+        record.time = text("time");
+        record.program = text("program");
+        record.instance = text("instance");
+        record.git = text("git");
+        record.flags = text("flags");
+        record.seed = std::strtoull(text("seed").c_str(), nullptr, 10);
+        record.threads = static_cast<int>(number_of("threads"));
+        record.deterministic = text("deterministic") == "true";
+        record.parse_sec = number_of("parse_sec");
+        record.wall_sec = number_of("wall_sec");
+        record.cpu_sec = number_of("cpu_sec");
+        record.peak_rss_kb = static_cast<long>(number_of("peak_rss_kb"));
+        record.size = static_cast<int64_t>(number_of("size"));
+        record.minimize = text("minimize") == "true";
+        records.push_back(record);
+    }
+    return true;
+}
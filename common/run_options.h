@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "json.h"
+#include "random.h"
+
+// Options shared by all drivers:
+//   --seed N          run seed (default kDefaultSeed)
+//   --threads N       worker threads for solvers with a parallel mode
+//   --deterministic   parallel results independent of thread scheduling
+//   --time-limit S    seconds per instance for solvers that can stop early, 0 for none
+//   --output PATH     results table instead of the driver's default file
+//   --input-dir DIR   where instance names without a directory are looked up
+//   --config FILE     the same options as a JSON object, see ApplyConfig
+//   --results-log F   JSONL file every run is appended to (results.jsonl), "" for none
+//   --tag NAME        label of the run in the results log, for compare-results
+// Drivers can accept their own options by name: `value_options` take one argument and end up
+// in `values`, `flag_options` take none and end up in `flags`.
+// Everything that is not an option is returned in `positional`: instance files or globs.
+
+// Option values for the instances whose file name matches `pattern` (* and ? wildcards).
+struct InstanceOverride
+{
+    std::string pattern;
+    std::map<std::string, std::string> values;
+};
+
+struct RunOptions
+{
+    uint64_t seed = kDefaultSeed;
+    int threads = 1;
+    bool deterministic = false;
+    double time_limit = 0.0;
+    std::string output;
+    std::string input_dir;
+    std::string results_log = "results.jsonl";
+    std::string tag;
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> values;
+    std::set<std::string> flags;
+    std::vector<InstanceOverride> overrides; // later ones win
+
+    std::string Value(const std::string& name, const std::string& fallback = "") const
+    {
+        auto it = values.find(name);
+        return it == values.end() ? fallback : it->second;
+    }
+
+    bool Flag(const std::string& name) const
+    {
+        return flags.count(name) != 0;
+    }
+
+    // Value for one instance: the last override matching its file name, else Value
+    std::string InstanceValue(const std::string& instance, const std::string& name,
+                              const std::string& fallback = "") const;
+};
+
+// * matches any run of characters, ? any single one
+inline bool MatchWildcard(const std::string& pattern, const std::string& text)
+{
+    size_t p = 0, t = 0;
+    size_t star = std::string::npos, resume = 0;
+    while (t < text.size())
+    {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]))
+        {
+            ++p;
+            ++t;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            star = p++;
+            resume = t;
+        }
+        else if (star != std::string::npos)
+        {
+            p = star + 1;
+            t = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+inline std::string RunOptions::InstanceValue(const std::string& instance, const std::string& name,
+                                             const std::string& fallback) const
+{
+    const std::string file_name = std::filesystem::path(instance).filename().string();
+    for (auto it = overrides.rbegin(); it != overrides.rend(); ++it)
+    {
+        auto value = it->values.find(name);
+        if (value != it->values.end() && (MatchWildcard(it->pattern, file_name) || MatchWildcard(it->pattern, instance)))
+            return value->second;
+    }
+    return Value(name, fallback);
+}
+
+// A JSON config holds the command line options as members named like the options without
+// the dashes, e.g. {"threads": 4, "time-limit": 30, "iterations": 1000, "deterministic": true},
+// plus "inputs" (a file or glob, or a list of them) and "instances", an object that maps file
+// name patterns to option values for the matching instances:
+//   "instances": {"MANN_a27*": {"iterations": 100}, "p_hat*": {"randomization": 10}}
+// Options given on the command line win over the file.
+inline bool ApplyConfig(const JsonValue& config, RunOptions& options, const std::vector<std::string>& value_options,
+                        const std::vector<std::string>& flag_options)
+{
+    auto is = [](const std::vector<std::string>& names, const std::string& name)
+    {
+        return std::find(names.begin(), names.end(), name) != names.end();
+    };
+    if (config.type != JsonValue::Type::Object)
+    {
+        std::cerr << "Error: A config file must hold a JSON object\n";
+        return false;
+    }
+    for (const auto& [name, value] : config.members)
+    {
+        try
+        {
+            if (name == "inputs" && (value.type == JsonValue::Type::String || value.type == JsonValue::Type::Array))
+            {
+                options.positional.clear();
+                const std::vector<JsonValue> single(1, value);
+                for (const JsonValue& input : value.type == JsonValue::Type::Array ? value.items : single)
+                {
+                    if (input.type != JsonValue::Type::String)
+                        throw std::invalid_argument(name);
+                    options.positional.push_back(input.text);
+                }
+            }
+            else if (name == "instances" && value.type == JsonValue::Type::Object)
+            {
+                for (const auto& [pattern, settings] : value.members)
+                {
+                    InstanceOverride instance_override{pattern, {}};
+                    for (const auto& [key, setting] : settings.members)
+                    {
+                        if (!is(value_options, key) || !setting.IsScalar())
+                        {
+                            std::cerr << "Error: Unknown per-instance option '" << key << "' for '" << pattern << "'\n";
+                            return false;
+                        }
+                        instance_override.values[key] = setting.ScalarText();
+                    }
+                    options.overrides.push_back(instance_override);
+                }
+            }
+            else if (!value.IsScalar())
+            {
+                throw std::invalid_argument(name);
+            }
+            else if (name == "seed")
+            {
+                options.seed = std::stoull(value.text);
+            }
+            else if (name == "threads")
+            {
+                options.threads = std::max(1, std::stoi(value.text));
+            }
+            else if (name == "deterministic" && value.type == JsonValue::Type::Bool)
+            {
+                options.deterministic = value.boolean;
+            }
+            else if (name == "time-limit")
+            {
+                options.time_limit = std::max(0.0, std::stod(value.text));
+            }
+            else if (name == "output")
+            {
+                options.output = value.text;
+            }
+            else if (name == "input-dir")
+            {
+                options.input_dir = value.text;
+            }
+            else if (name == "results-log")
+            {
+                options.results_log = value.text;
+            }
+            else if (name == "tag")
+            {
+                options.tag = value.text;
+            }
+            else if (is(value_options, name))
+            {
+                options.values[name] = value.ScalarText();
+            }
+            else if (is(flag_options, name) && value.type == JsonValue::Type::Bool)
+            {
+                if (value.boolean)
+                    options.flags.insert(name);
+                else
+                    options.flags.erase(name);
+            }
+            else
+            {
+                std::cerr << "Error: Unknown config option '" << name << "'\n";
+                return false;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "Error: Invalid value for config option '" << name << "'\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool ParseRunOptions(int argc, char** argv, RunOptions& options,
+                            const std::vector<std::string>& value_options = {},
+                            const std::vector<std::string>& flag_options = {})
+{
+    auto known = [](const std::vector<std::string>& names, const std::string& arg)
+    {
+        return arg.rfind("--", 0) == 0 && std::find(names.begin(), names.end(), arg.substr(2)) != names.end();
+    };
+
+    // the config file first, so that the command line can override it
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--config")
+        {
+            JsonValue config;
+            if (!ReadJsonFile(argv[i + 1], config) || !ApplyConfig(config, options, value_options, flag_options))
+                return false;
+            break;
+        }
+    }
+
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        try
+        {
+            if (arg == "--config" && i + 1 < argc)
+            {
+                ++i;
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                options.seed = std::stoull(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                options.threads = std::max(1, std::stoi(argv[++i]));
+            }
+            else if (arg == "--deterministic")
+            {
+                options.deterministic = true;
+            }
+            else if (arg == "--time-limit" && i + 1 < argc)
+            {
+                options.time_limit = std::max(0.0, std::stod(argv[++i]));
+            }
+            else if (arg == "--output" && i + 1 < argc)
+            {
+                options.output = argv[++i];
+            }
+            else if (arg == "--input-dir" && i + 1 < argc)
+            {
+                options.input_dir = argv[++i];
+            }
+            else if (arg == "--results-log" && i + 1 < argc)
+            {
+                options.results_log = argv[++i];
+            }
+            else if (arg == "--tag" && i + 1 < argc)
+            {
+                options.tag = argv[++i];
+            }
+            else if (known(value_options, arg) && i + 1 < argc)
+            {
+                options.values[arg.substr(2)] = argv[++i];
+            }
+            else if (known(flag_options, arg))
+            {
+                options.flags.insert(arg.substr(2));
+            }
+            else if (arg.rfind("--", 0) == 0)
+            {
+                std::cerr << "Error: Unknown option '" << arg << "'\n";
+                return false;
+            }
+            else
+            {
+                positional.push_back(arg);
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "Error: Invalid value for option '" << arg << "'\n";
+            return false;
+        }
+    }
+    if (!positional.empty())
+        options.positional = positional;
+    return true;
+}
+
+// An instance to run: `path` to open and `name` for the results, as given or as matched.
+struct InstanceFile
+{
+    std::string path;
+    std::string name;
+};
+
+// The positional arguments, or `default_files` when there are none. Names without a directory
+// are looked up in --input-dir, else in `default_dir`; a * or ? in the file name part expands
+// to the matching files of that directory, in name order.
+inline std::vector<InstanceFile> ListInstances(const RunOptions& options, const std::string& default_dir,
+                                               const std::vector<std::string>& default_files)
+{
+    namespace fs = std::filesystem;
+    const std::string dir = options.input_dir.empty() ? default_dir : options.input_dir;
+    std::vector<InstanceFile> instances;
+    for (const std::string& entry : options.positional.empty() ? default_files : options.positional)
+    {
+        fs::path path(entry);
+        if (!path.has_parent_path() && !dir.empty())
+            path = fs::path(dir) / path;
+        const std::string pattern = path.filename().string();
+        if (pattern.find_first_of("*?") == std::string::npos)
+        {
+            instances.push_back({path.string(), entry});
+            continue;
+        }
+
+        const fs::path parent = path.has_parent_path() ? path.parent_path() : fs::path(".");
+        std::vector<std::string> matches;
+        std::error_code error;
+        for (fs::directory_iterator it(parent, error), end; !error && it != end; it.increment(error))
+        {
+            const std::string file_name = it->path().filename().string();
+            if (it->is_regular_file(error) && MatchWildcard(pattern, file_name))
+                matches.push_back(file_name);
+        }
+        if (matches.empty())
+            std::cerr << "Warning: No files match '" << path.string() << "'\n";
+        std::sort(matches.begin(), matches.end());
+        for (const std::string& file_name : matches) instances.push_back({(parent / file_name).string(), file_name});
+    }
+    return instances;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "random.h"
+
+// Upper bounds on the clique weight of vertex sets whose search has finished, shared by all
+// B&B workers. A bound is a property of the set alone, so it stays valid whatever clique led
+// to the set and however the incumbent grows; on symmetric graphs sibling subtrees reach the
+// same candidate sets and skip the search the second time.
+//
+// A set is known by its size and two independent fingerprints of 64 and 32 bits instead of
+// its vertices, so two sets are confused with probability about 2^-96 per lookup. The table
+// is lock-free: an entry is two words, the first being the key xor the second, so that a
+// torn read of a concurrent write fails the check and reads as a miss (Hyatt, Mann). Buckets
+// of four entries are evicted by CLOCK: a hit sets an entry's reference bit, and a store
+// takes the first entry from the bucket's hand on whose bit is clear, clearing bits on the way.
+struct SetFingerprint
+{
+    uint64_t key = 0;
+    uint32_t check = 0;
+    uint32_t size = 0;
+};
+
+// Order-independent: sums of mixed vertex ids.
+inline SetFingerprint FingerprintSet(const std::vector<int>& vertices)
+{
+    SetFingerprint print;
+    uint64_t check = 0;
+    for (int v : vertices)
+    {
+        uint64_t a = static_cast<uint64_t>(v);
+        uint64_t b = static_cast<uint64_t>(v) ^ 0x5851F42D4C957F2DULL;
+        print.key += SplitMix64(a);
+        check += SplitMix64(b);
+    }
+    print.check = static_cast<uint32_t>(check >> 32);
+    print.size = static_cast<uint32_t>(vertices.size());
+    return print;
+}
+
+class SubproblemCache
+{
+public:
+    SubproblemCache() = default;
+
+    // about `megabytes` of entries, rounded down to a power of two buckets; 0 disables it
+    explicit SubproblemCache(size_t megabytes)
+    {
+        size_t buckets = 0;
+        const size_t want = megabytes * (size_t(1) << 20) / (kWays * (2 * sizeof(uint64_t) + 1));
+        if (want > 0)
+            for (buckets = 1; buckets * 2 <= want; buckets *= 2) {}
+        mask = buckets > 0 ? buckets - 1 : 0;
+        if (buckets == 0)
+            return;
+        words = std::make_unique<std::atomic<uint64_t>[]>(buckets * kWays * 2);
+        referenced = std::make_unique<std::atomic<uint8_t>[]>(buckets * kWays);
+        hands = std::make_unique<std::atomic<uint8_t>[]>(buckets);
+        for (size_t i = 0; i < buckets * kWays * 2; ++i) words[i].store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < buckets * kWays; ++i) referenced[i].store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < buckets; ++i) hands[i].store(0, std::memory_order_relaxed);
+    }
+
+    bool Enabled() const
+    {
+        return words != nullptr;
+    }
+
+    // The stored bound of the set, if any.
+    bool Lookup(const SetFingerprint& print, int& bound)
+    {
+        const size_t base = Bucket(print) * kWays;
+        for (size_t s = base; s < base + kWays; ++s)
+        {
+            uint64_t data;
+            if (!Matches(s, print, data))
+                continue;
+            referenced[s].store(1, std::memory_order_relaxed);
+            bound = static_cast<int>(data & kBoundMask);
+            return true;
+        }
+        return false;
+    }
+
+    // Records `bound` for the set, keeping the tighter one if it is there already.
+    // Returns whether an entry of another set was evicted for it.
+    bool Store(const SetFingerprint& print, int bound)
+    {
+        const size_t bucket = Bucket(print);
+        const size_t base = bucket * kWays;
+        const uint64_t data = (static_cast<uint64_t>(print.check) << 32) | kOccupied |
+                              (static_cast<uint64_t>(bound) & kBoundMask);
+        for (size_t s = base; s < base + kWays; ++s)
+        {
+            uint64_t old;
+            if (!Matches(s, print, old))
+                continue;
+            if (bound < static_cast<int>(old & kBoundMask))
+                Write(s, print, data);
+            return false;
+        }
+
+        // second chance: the bucket's first entry without a recent hit, empty ones first
+        size_t victim = base + hands[bucket].load(std::memory_order_relaxed) % kWays;
+        for (size_t s = base; s < base + kWays; ++s)
+        {
+            if (words[2 * s + 1].load(std::memory_order_relaxed) == 0)
+            {
+                victim = s;
+                break;
+            }
+        }
+        if (words[2 * victim + 1].load(std::memory_order_relaxed) != 0)
+        {
+            for (size_t step = 0; step < 2 * kWays; ++step)
+            {
+                const uint8_t hand = hands[bucket].load(std::memory_order_relaxed);
+                hands[bucket].store(static_cast<uint8_t>((hand + 1) % kWays), std::memory_order_relaxed);
+                victim = base + hand % kWays;
+                if (referenced[victim].exchange(0, std::memory_order_relaxed) == 0)
+                    break;
+            }
+        }
+        const bool evicted = words[2 * victim + 1].load(std::memory_order_relaxed) != 0;
+        referenced[victim].store(0, std::memory_order_relaxed);
+        Write(victim, print, data);
+        return evicted;
+    }
+
+private:
+    static constexpr size_t kWays = 4;
+    static constexpr uint64_t kBoundMask = 0x7FFFFFFFULL;
+    static constexpr uint64_t kOccupied = 0x80000000ULL; // so that a used entry is never 0
+
+    size_t Bucket(const SetFingerprint& print) const
+    {
+        return static_cast<size_t>(print.key ^ (static_cast<uint64_t>(print.size) * 0x9E3779B97F4A7C15ULL)) & mask;
+    }
+
+    uint64_t Key(const SetFingerprint& print) const
+    {
+        return print.key + print.size;
+    }
+
+    bool Matches(size_t slot, const SetFingerprint& print, uint64_t& data) const
+    {
+        const uint64_t first = words[2 * slot].load(std::memory_order_relaxed);
+        data = words[2 * slot + 1].load(std::memory_order_relaxed);
+        return data != 0 && (first ^ data) == Key(print) && static_cast<uint32_t>(data >> 32) == print.check;
+    }
+
+    void Write(size_t slot, const SetFingerprint& print, uint64_t data)
+    {
+        words[2 * slot].store(Key(print) ^ data, std::memory_order_relaxed);
+        words[2 * slot + 1].store(data, std::memory_order_relaxed);
+    }
+
+    size_t mask = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> words; // per entry: key ^ data, data = check << 32 | occupied | bound
+    std::unique_ptr<std::atomic<uint8_t>[]> referenced;
+    std::unique_ptr<std::atomic<uint8_t>[]> hands;
+};
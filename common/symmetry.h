@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "graph_io.h"
+#include "random.h"
+
+// Vertex orbits of the automorphism group, or a finer partition of them. Color refinement
+// (1-dimensional Weisfeiler-Leman) splits the vertices into cells that every automorphism
+// preserves. Within a cell, an automorphism taking its first vertex to another one is
+// looked for along a single individualization-refinement path, as in nauty but without
+// backtracking; every permutation found is checked edge by edge before its cycles are
+// merged into orbits. A failed search proves nothing and leaves the vertices apart, so the
+// result is always a partition of real orbits, just possibly not the coarsest one.
+
+namespace symmetry_detail
+{
+    inline uint64_t Mix(uint64_t value)
+    {
+        return SplitMix64(value);
+    }
+
+    // Refines `colors` to the coarsest equitable partition below it. New colors are ranks of
+    // (old color, neighbour color multiset), so two isomorphic inputs get the same colors at
+    // corresponding vertices. Returns the number of colors.
+    inline int Refine(const CsrGraph& graph, std::vector<int>& colors, int color_count)
+    {
+        const int n = graph.n;
+        std::vector<std::pair<uint64_t, int>> keys(n);
+        std::vector<uint64_t> signature(n);
+        while (true)
+        {
+            for (int v = 0; v < n; ++v)
+            {
+                uint64_t sum = 0;
+                for (int u : graph.Neighbours(v)) sum += Mix(static_cast<uint64_t>(colors[u]));
+                signature[v] = sum;
+            }
+            for (int v = 0; v < n; ++v) keys[v] = {signature[v], v};
+            std::sort(keys.begin(), keys.end(), [&](const auto& a, const auto& b)
+            {
+                if (colors[a.second] != colors[b.second])
+                    return colors[a.second] < colors[b.second];
+                return a.first < b.first;
+            });
+            std::vector<int> next(n);
+            int count = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                if (i > 0 && (colors[keys[i].second] != colors[keys[i - 1].second] || keys[i].first != keys[i - 1].first))
+                    ++count;
+                next[keys[i].second] = count;
+            }
+            ++count;
+            colors.swap(next);
+            if (count == color_count)
+                return count;
+            color_count = count;
+        }
+    }
+
+    inline std::vector<int> ColorSizes(const std::vector<int>& colors, int color_count)
+    {
+        std::vector<int> sizes(color_count, 0);
+        for (int c : colors) ++sizes[c];
+        return sizes;
+    }
+
+    // An automorphism with `from` -> `to`, both in the same cell of the equitable `colors`.
+    inline bool FindAutomorphism(const CsrGraph& graph, const std::vector<int>& colors, int color_count, int from,
+                                 int to, std::vector<int>& permutation)
+    {
+        const int n = graph.n;
+        std::vector<int> a = colors, b = colors;
+        int count = color_count;
+        int x = from, y = to;
+        while (true)
+        {
+            a[x] = count;
+            b[y] = count;
+            const int count_a = Refine(graph, a, count + 1);
+            const int count_b = Refine(graph, b, count + 1);
+            if (count_a != count_b)
+                return false;
+            count = count_a;
+            const std::vector<int> sizes = ColorSizes(a, count);
+            if (sizes != ColorSizes(b, count))
+                return false;
+            if (count == n)
+                break;
+
+            // individualize the first vertex of the first non-singleton cell on both sides
+            const int cell = static_cast<int>(std::find_if(sizes.begin(), sizes.end(), [](int s) { return s > 1; }) -
+                                              sizes.begin());
+            x = static_cast<int>(std::find(a.begin(), a.end(), cell) - a.begin());
+            y = static_cast<int>(std::find(b.begin(), b.end(), cell) - b.begin());
+        }
+
+        std::vector<int> at_color(n);
+        for (int v = 0; v < n; ++v) at_color[b[v]] = v;
+        permutation.resize(n);
+        for (int v = 0; v < n; ++v) permutation[v] = at_color[a[v]];
+        for (int v = 0; v < n; ++v)
+        {
+            if (graph.Degree(v) != graph.Degree(permutation[v]))
+                return false;
+            for (int u : graph.Neighbours(v))
+                if (!graph.HasEdge(permutation[v], permutation[u])) return false;
+        }
+        return true;
+    }
+
+    inline int Find(std::vector<int>& parent, int v)
+    {
+        while (parent[v] != v) v = parent[v] = parent[parent[v]];
+        return v;
+    }
+}
+
+// orbit[v] is the smallest vertex known to be in the orbit of v. Vertices of different
+// `labels` (e.g. weights; empty for none) are never merged. At most `max_failures`
+// automorphism searches may fail before the rest are given up.
+inline std::vector<int> VertexOrbits(const CsrGraph& graph, const std::vector<int>& labels, int max_failures = 32)
+{
+    using namespace symmetry_detail;
+    const int n = graph.n;
+    std::vector<int> colors(n, 0);
+    int color_count = 1;
+    if (!labels.empty())
+    {
+        std::vector<int> distinct = labels;
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        for (int v = 0; v < n; ++v)
+            colors[v] = static_cast<int>(std::lower_bound(distinct.begin(), distinct.end(), labels[v]) - distinct.begin());
+        color_count = static_cast<int>(distinct.size());
+    }
+    if (n > 0)
+        color_count = Refine(graph, colors, color_count);
+
+    std::vector<std::vector<int>> cells(color_count);
+    for (int v = 0; v < n; ++v) cells[colors[v]].push_back(v);
+
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<int> permutation;
+    int failures = 0;
+    for (const std::vector<int>& cell : cells)
+    {
+        for (size_t i = 1; i < cell.size() && failures < max_failures; ++i)
+        {
+            if (Find(parent, cell[i]) == Find(parent, cell[0]))
+                continue;
+            if (!FindAutomorphism(graph, colors, color_count, cell[0], cell[i], permutation))
+            {
+                ++failures;
+                continue;
+            }
+            for (int v = 0; v < n; ++v)
+            {
+                const int a = Find(parent, v), b = Find(parent, permutation[v]);
+                if (a != b)
+                    parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    std::vector<int> orbit(n);
+    for (int v = 0; v < n; ++v) orbit[v] = Find(parent, v);
+    return orbit;
+}
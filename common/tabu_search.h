@@ -0,0 +1,845 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "bit_graph.h"
+#include "graph_io.h"
+#include "random.h"
+#include "vertex_order.h"
+
+// The latest partial clique handed from one solver to another. Offer never blocks: when the
+// box is busy the clique is dropped, the next one will do as well.
+class CliqueSeedBox
+{
+public:
+    void Offer(const std::vector<int>& clique)
+    {
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return;
+        seed = clique;
+        fresh = true;
+    }
+
+    bool Take(std::vector<int>& clique)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!fresh)
+            return false;
+        clique.swap(seed);
+        fresh = false;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<int> seed;
+    bool fresh = false;
+};
+
+// Tunable constants of the search: tabu tenure (start value and the range it adapts in),
+// the stall limit before diversification (stall_factor * n steps, at least min_stall), and
+// the weights of the insertion score (C0 degree, degree, insertion frequency).
+struct TabuParams
+{
+    int base_tenure = 7;
+    int min_tenure = 5;
+    int max_tenure = 60;
+    int stall_factor = 5;
+    int min_stall = 500;
+    double c0_weight = 2000.0;
+    double degree_weight = 1.5;
+    double frequency_weight = 0.1;
+};
+
+// What the search needs of a graph besides its neighbour lists: bitset rows for adjacency
+// tests and the sorted non-neighbour lists, O(n^2) to build and to store. Read-only, so one
+// instance can serve every search on the same graph (SetGraph with a shared TabuGraph).
+struct TabuGraph
+{
+    BitGraph adjacency_bits;
+    CsrGraph non_neighbours;
+
+    explicit TabuGraph(const CsrGraph& graph) : adjacency_bits(graph)
+    {
+        // explicit non-neighbour lists (used for O(deg_non) tightness updates), stored as
+        // one contiguous sorted array like the neighbour lists; each complement is a single
+        // merge pass over the sorted neighbours
+        const int vertices = graph.n;
+        non_neighbours.n = vertices;
+        non_neighbours.offsets.reserve(static_cast<size_t>(vertices) + 1);
+        non_neighbours.adjacency.reserve(static_cast<size_t>(vertices) * (vertices - 1) - 2 * graph.EdgeCount());
+        for (int i = 0; i < vertices; ++i)
+        {
+            auto neighbours = graph.Neighbours(i);
+            size_t k = 0;
+            for (int j = 0; j < vertices; ++j)
+            {
+                if (k < neighbours.size() && neighbours[k] == j)
+                    ++k;
+                else if (i != j)
+                    non_neighbours.adjacency.push_back(j);
+            }
+            non_neighbours.offsets.push_back(non_neighbours.adjacency.size());
+        }
+    }
+};
+
+// Rng: random engine of the search, see Next32 in random.h for the requirements
+template <class Rng = Xoshiro256pp>
+class MaxCliqueTabuSearch
+{
+public:
+    explicit MaxCliqueTabuSearch(uint64_t seed = kDefaultSeed) : seed(seed) {}
+
+    // ordering: vertex ids are relabeled for locality, GetClique reports the file's ids
+    void ReadGraphFile(std::string filename, VertexOrdering ordering = VertexOrdering::None)
+    {
+        CsrGraph csr;
+        DimacsInfo info;
+        ReadDimacsGraph(filename, csr, info);
+        VertexRelabeling labels = RelabelGraph(csr, ordering);
+        SetGraph(std::move(csr), std::move(labels));
+    }
+
+    // a graph that is already in memory; `labels` maps its ids to the ones GetClique reports
+    void SetGraph(CsrGraph csr, VertexRelabeling labels = {})
+    {
+        auto built = std::make_shared<const TabuGraph>(csr);
+        SetGraph(std::move(csr), std::move(built), std::move(labels));
+    }
+
+    // the same with the TabuGraph of `csr` built beforehand, shared with other searches
+    void SetGraph(CsrGraph csr, std::shared_ptr<const TabuGraph> tabu_graph, VertexRelabeling labels = {})
+    {
+        graph = std::move(csr);
+        prepared = std::move(tabu_graph);
+        relabeling = std::move(labels);
+        reported_size = 0;
+        degrees.assign(graph.n, 0);
+        for (int i = 0; i < graph.n; ++i)
+            degrees[i] = graph.Degree(i);
+    }
+
+    // Hooks for running next to another solver: `improved` gets every clique larger than all
+    // the ones before it (in the ids of the graph given to SetGraph), the search returns soon
+    // after `stop` is set or after `patience` steps without a better clique (0: never), and a
+    // clique waiting in `seeds` replaces the initial one and the next diversification.
+    void Connect(std::function<void(const std::vector<int>&)> improved, const std::atomic<bool>* stop,
+                 CliqueSeedBox* seeds, int patience = 0)
+    {
+        improved_sink = std::move(improved);
+        stop_flag = stop;
+        seed_box = seeds;
+        patience_steps = patience;
+    }
+
+    // RunSearch returns `seconds` after this call; 0 for no limit
+    void SetTimeLimit(double seconds)
+    {
+        has_deadline = seconds > 0.0;
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                          std::chrono::duration<double>(seconds));
+    }
+
+    void SetParams(const TabuParams& search_params)
+    {
+        params = search_params;
+        params.min_tenure = std::max(1, params.min_tenure);
+        params.max_tenure = std::max(params.min_tenure, params.max_tenure);
+    }
+
+    // a new stream for the next RunSearch
+    void SetSeed(uint64_t new_seed)
+    {
+        seed = new_seed;
+    }
+
+    // iterations: number of tabu steps per instance
+    // randomization: tournament size for choosing candidates
+    void RunSearch(int iterations, int randomization)
+    {
+        if (graph.n == 0)
+            return;
+
+        randomization = std::max(1, randomization);
+        iterations = std::max(1, iterations);
+
+        const int n = graph.n;
+        
+        const int num_restarts = std::min(3, std::max(1, n / 200));
+        int global_best_size = 0;
+        std::vector<int> global_best_vector;
+
+        for (int restart = 0; restart < num_restarts; ++restart)
+        {
+            // every restart has its own stream, so it can be reproduced on its own
+            rng.seed(DeriveSeed(seed, restart));
+            InitializeState(n);
+            
+            // initial maximal clique (randomized greedy)
+            BuildInitialClique(randomization);
+            if (RestartFromSeed())
+                ExpandGreedy(randomization, 0, 0, static_cast<int>(clique.size()));
+            best_vector = clique;
+            Report();
+
+            int best_size = static_cast<int>(best_vector.size());
+            int current_size = best_size;
+            int stall = 0;
+            const int stall_limit = std::max(params.min_stall, params.stall_factor * n);
+            int base_tenure = params.base_tenure;
+            int last_improvement = 0;
+            int intensification_count = 0;
+            bool in_intensification = false;
+
+            // adaptive parameters
+            double improvement_rate = 1.0;
+            int consecutive_swaps = 0;
+
+            for (int it = 1; it <= iterations / num_restarts && !Stopped(); ++it)
+            {
+                if (patience_steps > 0 && it - last_improvement > patience_steps)
+                    break;
+
+                // expand to a maximal clique with non-tabu insertions
+                ExpandGreedy(randomization, it, best_size, current_size);
+
+                current_size = static_cast<int>(clique.size());
+
+                if (current_size > best_size)
+                {
+                    best_size = current_size;
+                    best_vector = clique;
+                    Report();
+                    stall = 0;
+                    last_improvement = it;
+                    in_intensification = false;
+                    intensification_count = 0;
+                    improvement_rate = 1.0;
+                    
+                    // reduce when finding improvements
+                    base_tenure = std::max(params.min_tenure, base_tenure - 1);
+                }
+                else
+                {
+                    ++stall;
+                    improvement_rate = 0.95 * improvement_rate;
+                }
+
+                // when we find a good solution, intensify search
+                if (current_size >= best_size - 1 && !in_intensification && it - last_improvement < 100)
+                {
+                    in_intensification = true;
+                    intensification_count = 0;
+                }
+
+                if (in_intensification)
+                {
+                    ++intensification_count;
+                    if (intensification_count > 200 || current_size < best_size - 2)
+                    {
+                        in_intensification = false;
+                        intensification_count = 0;
+                    }
+                }
+
+                // trigger earlier if improvement rate is low
+                int adaptive_stall_limit = stall_limit;
+                if (improvement_rate < 0.3 && it > iterations / (2 * num_restarts))
+                {
+                    adaptive_stall_limit = stall_limit / 2;
+                }
+
+                if (stall >= adaptive_stall_limit)
+                {
+                    // remove a chunk of vertices (or restart from a seed), then rebuild
+                    if (!RestartFromSeed())
+                        Diversify(it, base_tenure);
+                    stall = 0;
+                    base_tenure = std::min(std::max(params.min_tenure, params.max_tenure / 2), base_tenure + 2);
+                    improvement_rate = 1.0;
+                    in_intensification = false;
+                    continue;
+                }
+
+                // if no swap exists, drop one vertex
+                if (HasAdmissibleAdd(it, best_size, current_size))
+                {
+                    consecutive_swaps = 0;
+                    continue;
+                }
+
+                if (TrySwap(it, randomization, base_tenure, best_size, current_size))
+                {
+                    ++consecutive_swaps;
+                    // if too many swaps in a row, drop one to diversify
+                    if (consecutive_swaps > 50)
+                    {
+                        DropOne(it, base_tenure);
+                        consecutive_swaps = 0;
+                    }
+                    continue;
+                }
+
+                consecutive_swaps = 0;
+                DropOne(it, base_tenure);
+            }
+
+            if (best_size > global_best_size)
+            {
+                global_best_size = best_size;
+                global_best_vector = best_vector;
+            }
+        }
+
+        best_vector = global_best_vector;
+        best_clique.clear();
+        for (int v : best_vector)
+            best_clique.insert(v);
+    }
+
+    std::unordered_set<int> GetClique()
+    {
+        std::unordered_set<int> result;
+        for (int v : best_clique) result.insert(relabeling.ToOriginal(v));
+        return result;
+    }
+
+    bool Check()
+    {
+        for (int i : best_clique)
+        {
+            for (int j : best_clique)
+            {
+                if (i != j && !prepared->adjacency_bits.IsAdjacent(i, j))
+                {
+                    std::cout << "Returned subgraph is not clique\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ClearClique()
+    {
+        clique.clear();
+    }
+
+private:
+    struct FastSet
+    {
+        std::vector<int> items;
+        std::vector<int> pos; // -1 means not in set
+
+        void Init(int n)
+        {
+            items.clear();
+            pos.assign(n, -1);
+        }
+
+        bool Contains(int v) const { return pos[v] != -1; }
+        int Size() const { return static_cast<int>(items.size()); }
+
+        void Add(int v)
+        {
+            if (pos[v] != -1)
+                return;
+            pos[v] = static_cast<int>(items.size());
+            items.push_back(v);
+        }
+
+        void Remove(int v)
+        {
+            int p = pos[v];
+            if (p == -1)
+                return;
+            int last = items.back();
+            items[p] = last;
+            pos[last] = p;
+            items.pop_back();
+            pos[v] = -1;
+        }
+    };
+
+    // sorted neighbour and non-neighbour arrays for iteration, bitset rows for adjacency tests
+    CsrGraph graph;
+    std::shared_ptr<const TabuGraph> prepared;
+    VertexRelabeling relabeling;
+    std::unordered_set<int> best_clique;
+    std::vector<int> degrees;
+
+    // search state
+    uint64_t seed;
+    Rng rng;
+    std::vector<int> clique;
+    std::vector<int> best_vector;
+    std::vector<int> pos_in_clique;
+    std::vector<char> in_clique;
+    std::vector<int> tight;      // tight[v] = # of clique vertices non-adjacent to v
+    FastSet C0;             // tight==0 and not in clique
+    FastSet C1;             // tight==1 and not in clique
+    std::vector<int> tabu_until; // forbids inserting vertex v while it > current_iter
+    std::vector<int> freq;       // insertion frequency
+
+    TabuParams params;
+
+    // hybrid hooks, see Connect
+    std::function<void(const std::vector<int>&)> improved_sink;
+    const std::atomic<bool>* stop_flag = nullptr;
+    CliqueSeedBox* seed_box = nullptr;
+    int reported_size = 0;
+    int patience_steps = 0;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::vector<int> seed_clique;
+
+    int RandInt(int a, int b)
+    {
+        return UniformInt(rng, a, b);
+    }
+
+    bool Stopped() const
+    {
+        return (stop_flag != nullptr && stop_flag->load(std::memory_order_relaxed)) ||
+               (has_deadline && std::chrono::steady_clock::now() >= deadline);
+    }
+
+    void Report()
+    {
+        if (!improved_sink || static_cast<int>(clique.size()) <= reported_size)
+            return;
+        reported_size = static_cast<int>(clique.size());
+        improved_sink(clique);
+    }
+
+    // Replaces the current clique by the waiting seed; the caller's next step extends it.
+    bool RestartFromSeed()
+    {
+        if (seed_box == nullptr || !seed_box->Take(seed_clique))
+            return false;
+        while (!clique.empty()) RemoveFromClique(clique.back());
+        for (int v : seed_clique)
+        {
+            if (v >= 0 && v < graph.n && !in_clique[v] && tight[v] == 0)
+                AddToClique(v);
+        }
+        return true;
+    }
+
+    void InitializeState(int n)
+    {
+        clique.clear();
+        best_vector.clear();
+        pos_in_clique.assign(n, -1);
+        in_clique.assign(n, 0);
+        tight.assign(n, 0);
+        C0.Init(n);
+        C1.Init(n);
+        tabu_until.assign(n, 0);
+        freq.assign(n, 0);
+
+        // empty clique => every vertex is feasible to add
+        for (int v = 0; v < n; ++v)
+            C0.Add(v);
+    }
+
+    void AddToClique(int v)
+    {
+        C0.Remove(v);
+        C1.Remove(v);
+
+        in_clique[v] = 1;
+        pos_in_clique[v] = static_cast<int>(clique.size());
+        clique.push_back(v);
+
+        ++freq[v];
+        tight[v] = 0;
+
+        for (int u : prepared->non_neighbours.Neighbours(v))
+        {
+            if (in_clique[u])
+                continue;
+            int old = tight[u];
+            ++tight[u];
+            if (old == 0)
+            {
+                C0.Remove(u);
+                C1.Add(u);
+            }
+            else if (old == 1)
+            {
+                C1.Remove(u);
+            }
+        }
+    }
+
+    void RemoveFromClique(int v)
+    {
+        int p = pos_in_clique[v];
+        if (p == -1)
+            return;
+
+        int last = clique.back();
+        clique[p] = last;
+        pos_in_clique[last] = p;
+        clique.pop_back();
+        pos_in_clique[v] = -1;
+        in_clique[v] = 0;
+
+        // v was in the clique, so now its tightness becomes 0
+        tight[v] = 0;
+        C0.Add(v);
+        C1.Remove(v);
+
+        for (int u : prepared->non_neighbours.Neighbours(v))
+        {
+            if (in_clique[u])
+                continue;
+            int old = tight[u];
+            --tight[u];
+            if (old == 1)
+            {
+                C1.Remove(u);
+                C0.Add(u);
+            }
+            else if (old == 2)
+            {
+                C1.Add(u);
+            }
+        }
+    }
+
+    int CurrentTenure(int base_tenure) const
+    {
+        int t = base_tenure + static_cast<int>(clique.size()) / 8;
+        return std::min(params.max_tenure, std::max(params.min_tenure, t));
+    }
+
+    bool IsTabuToInsert(int v, int iter) const
+    {
+        return tabu_until[v] > iter;
+    }
+
+    // improved aspiration: allow tabu moves that lead to significant improvements
+    bool IsAspiration(int v, int iter, int best_size, int current_size) const
+    {
+        const int target = static_cast<int>(clique.size()) + 1;
+        // improves best
+        if (target > best_size)
+            return true;
+        // significantly improves current (within 1 of best)
+        if (target >= best_size && current_size < best_size - 1)
+            return true;
+        return false;
+    }
+
+    bool HasAdmissibleAdd(int iter, int best_size, int current_size) const
+    {
+        if (C0.Size() == 0)
+            return false;
+        for (int v : C0.items)
+        {
+            if (!IsTabuToInsert(v, iter) || IsAspiration(v, iter, best_size, current_size))
+                return true;
+        }
+        return false;
+    }
+
+    int ChooseFromC0Tournament(int k, int iter, int best_size, int current_size) 
+    {
+        if (C0.Size() == 0)
+            return -1;
+
+        k = std::min(k, C0.Size());
+        // if too small, just return first feasible
+        int tries = std::min(C0.Size(), std::max(50, k * 15));
+        int best_v = -1;
+        double best_score = -1e100;
+
+        auto neighbors_in_C0 = [&](int v) -> int
+        {
+            int cnt = 0;
+            for (int u : graph.Neighbours(v))
+            {
+                if (!in_clique[u] && tight[u] == 0)
+                    ++cnt;
+            }
+            return cnt;
+        };
+
+        // tournament: sample multiple random candidates from C0
+        for (int i = 0; i < tries; ++i)
+        {
+            int idx = RandInt(0, C0.Size() - 1);
+            int v = C0.items[idx];
+            bool is_tabu = IsTabuToInsert(v, iter);
+            if (is_tabu && !IsAspiration(v, iter, best_size, current_size))
+                continue;
+
+            // prefer vertices with high C0 degree and high degree, penalize frequency
+            int c0deg = neighbors_in_C0(v);
+            
+            // improved scoring: more weight to C0 degree, less to frequency
+            double score = params.c0_weight * static_cast<double>(c0deg) 
+                         + params.degree_weight * static_cast<double>(degrees[v]) 
+                         - params.frequency_weight * static_cast<double>(freq[v]);
+            
+            // slight penalty for tabu moves (even if allowed by aspiration)
+            if (is_tabu)
+                score *= 0.95;
+            
+            // small random tie-breaker
+            score += 1e-6 * RandInt(0, 1000000);
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_v = v;
+            }
+        }
+        return best_v;
+    }
+
+    void ExpandGreedy(int randomization, int iter, int best_size, int current_size)
+    {
+        int max_expansions = 1000;
+        int expansions = 0;
+        while (expansions < max_expansions)
+        {
+            int v = ChooseFromC0Tournament(randomization, iter, best_size, current_size);
+            if (v == -1)
+                return;
+            AddToClique(v);
+            ++expansions;
+            current_size = static_cast<int>(clique.size());
+        }
+    }
+
+    void BuildInitialClique(int randomization)
+    {
+        while (C0.Size() > 0)
+        {
+            int k = std::min(randomization, C0.Size());
+            int tries = std::min(C0.Size(), std::max(60, k * 12));
+            int best_v = -1;
+            double best_score = -1e100;
+
+            auto neighbors_in_C0 = [&](int v) -> int
+            {
+                int cnt = 0;
+                for (int u : graph.Neighbours(v))
+                {
+                    if (!in_clique[u] && tight[u] == 0)
+                        ++cnt;
+                }
+                return cnt;
+            };
+
+            for (int i = 0; i < tries; ++i)
+            {
+                int idx = RandInt(0, C0.Size() - 1);
+                int v = C0.items[idx];
+                int c0deg = neighbors_in_C0(v);
+                
+                // improved scoring for initial construction
+                double score = 1500.0 * static_cast<double>(c0deg) 
+                             + 1.2 * static_cast<double>(degrees[v]) 
+                             + 1e-6 * RandInt(0, 1000000);
+                
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_v = v;
+                }
+            }
+            if (best_v == -1)
+                break;
+            AddToClique(best_v);
+        }
+    }
+
+    int FindConflictVertexForC1(int v) const
+    {
+        // v has tight[v]==1, so there is exactly one vertex in the clique not adjacent to v
+        for (int u : clique)
+        {
+            if (!prepared->adjacency_bits.IsAdjacent(v, u))
+                return u;
+        }
+        return -1;
+    }
+
+    int SwapDeltaC0(int remove_u, int add_v) const
+    {
+        int gain = 0;
+        for (int w : prepared->non_neighbours.Neighbours(remove_u))
+        {
+            if (!in_clique[w] && tight[w] == 1)
+                ++gain;
+        }
+
+        int loss = 0;
+        for (int w : prepared->non_neighbours.Neighbours(add_v))
+        {
+            if (!in_clique[w] && tight[w] == 0)
+                ++loss;
+        }
+        return gain - loss;
+    }
+
+    double EvaluateSwap(int remove_u, int add_v, int iter, int best_size, int current_size) const
+    {
+        int delta = SwapDeltaC0(remove_u, add_v);
+        
+        // base score from C0 delta
+        double score = 100.0 * static_cast<double>(delta);
+        
+        // prefer swaps that maintain or improve solution quality
+        const int new_size = static_cast<int>(clique.size()); // same size after swap
+        if (new_size >= best_size - 1)
+            score += 50.0;
+        
+        // diversification: prefer adding vertices with low frequency and removing high frequency
+        score -= 0.5 * static_cast<double>(freq[add_v]);
+        score -= 0.2 * static_cast<double>(freq[remove_u]);
+        
+        // prefer removing vertices with lower degree (easier to replace)
+        score += 0.1 * static_cast<double>(degrees[remove_u]);
+        
+        // prefer adding vertices with higher degree (more connections)
+        score += 0.15 * static_cast<double>(degrees[add_v]);
+        
+        return score;
+    }
+
+    bool TrySwap(int iter, int randomization, int base_tenure, int best_size, int current_size)
+    {
+        if (C1.Size() == 0 || clique.empty())
+            return false;
+
+        int k = std::min(randomization, C1.Size());
+        int tries = std::min(C1.Size(), std::max(80, k * 15));
+        int best_v = -1;
+        int best_u = -1;
+        double best_score = -1e100;
+
+        for (int i = 0; i < tries; ++i)
+        {
+            int idx = RandInt(0, C1.Size() - 1);
+            int v = C1.items[idx];
+            bool is_tabu = IsTabuToInsert(v, iter);
+            if (is_tabu && !IsAspiration(v, iter, best_size, current_size))
+                continue;
+
+            int u = FindConflictVertexForC1(v);
+            if (u == -1)
+                continue;
+
+            double score = EvaluateSwap(u, v, iter, best_size, current_size);
+            
+            if (is_tabu)
+                score *= 0.9;
+            
+            score += 1e-6 * RandInt(0, 1000000);
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_v = v;
+                best_u = u;
+            }
+        }
+
+        if (best_v == -1)
+            return false;
+
+        RemoveFromClique(best_u);
+        tabu_until[best_u] = iter + CurrentTenure(base_tenure) + RandInt(0, base_tenure);
+        AddToClique(best_v);
+        return true;
+    }
+
+    void DropOne(int iter, int base_tenure)
+    {
+        if (clique.empty())
+            return;
+
+        int k = std::min(std::max(10, static_cast<int>(clique.size()) / 2), static_cast<int>(clique.size()));
+        int best_u = clique[RandInt(0, static_cast<int>(clique.size()) - 1)];
+        double best_score = -1e100;
+
+        for (int i = 0; i < k; ++i)
+        {
+            int u = clique[RandInt(0, static_cast<int>(clique.size()) - 1)];
+            int gain = 0;
+            for (int w : prepared->non_neighbours.Neighbours(u))
+            {
+                if (!in_clique[w] && tight[w] == 1)
+                    ++gain;
+            }
+
+            double score = 10.0 * static_cast<double>(gain) 
+                         + 0.3 * static_cast<double>(freq[u])
+                         - 0.05 * static_cast<double>(degrees[u]);
+            
+            score += 1e-6 * RandInt(0, 1000000);
+            
+            if (score > best_score)
+            {
+                best_score = score;
+                best_u = u;
+            }
+        }
+
+        RemoveFromClique(best_u);
+        tabu_until[best_u] = iter + CurrentTenure(base_tenure) + RandInt(0, base_tenure);
+    }
+
+    void Diversify(int iter, int base_tenure)
+    {
+        if (clique.empty())
+            return;
+
+        int remove_cnt = std::max(1, static_cast<int>(clique.size()) / 2);
+        remove_cnt = std::min(remove_cnt, static_cast<int>(clique.size()));
+
+        std::vector<std::pair<int, int>> candidates; // (freq, vertex)
+        for (int v : clique)
+        {
+            candidates.push_back({freq[v], v});
+        }
+        std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<int, int>>());
+
+        for (int i = 0; i < remove_cnt && i < static_cast<int>(candidates.size()); ++i)
+        {
+            // Prefer removing high-frequency vertices to escape well-trodden areas
+            int idx = i;
+            if (i < remove_cnt - 1 && RandInt(0, 100) < 30) // 30% chance to randomize
+            {
+                idx = RandInt(i, std::min(i + 3, static_cast<int>(candidates.size()) - 1));
+            }
+            
+            int best_u = candidates[idx].second;
+
+            RemoveFromClique(best_u);
+            // longer tabu tenure for diversification
+            tabu_until[best_u] = iter + 3 * CurrentTenure(base_tenure) + RandInt(0, 2 * base_tenure);
+
+            if (clique.empty())
+                break;
+        }
+    }
+};
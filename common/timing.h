@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no psapi.lib needed
+#endif
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Timing of the drivers. Wall time comes from steady_clock and CPU time from getrusage
+// (GetProcessTimes on Windows), so that multithreaded runs report both how long they took and
+// how much processor time all their threads used together; clock() only gives the latter.
+// The peak resident set is VmHWM on Linux, which ResetPeakRss can start over,
+// PeakWorkingSetSize on Windows and ru_maxrss elsewhere.
+
+// Starts a new high-water mark of the resident set, so that the peak of one instance does
+// not carry over into the rows of the next. Linux only; elsewhere, or if the kernel
+// refuses, returns false and the peak stays that of the whole process.
+inline bool ResetPeakRss()
+{
+#ifdef __linux__
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.close();
+    return static_cast<bool>(clear_refs);
+#else
+    return false;
+#endif
+}
+
+// VmHWM of /proc/self/status in KB on Linux, PeakWorkingSetSize on Windows, or `fallback`
+// if it cannot be read
+inline long PeakRssKb(long fallback)
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    counters.cb = sizeof(counters);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+#endif
+    return fallback;
+}
+
+// Resources used by the process up to one moment; a phase costs the difference of two.
+struct ResourceSnapshot
+{
+    std::chrono::steady_clock::time_point wall;
+    double cpu_sec = 0.0;  // user + system time of all threads
+    long peak_rss_kb = 0;  // high-water mark of the resident set since the last ResetPeakRss
+
+    static ResourceSnapshot Now()
+    {
+        ResourceSnapshot snapshot;
+        snapshot.wall = std::chrono::steady_clock::now();
+#ifdef _WIN32
+        FILETIME creation, exit_time, kernel, user;
+        if (GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user))
+        {
+            // 100 ns ticks
+            auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+            snapshot.cpu_sec = (ticks(kernel) + ticks(user)) * 1e-7;
+        }
+#else
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            snapshot.cpu_sec = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+                               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+            snapshot.peak_rss_kb = usage.ru_maxrss;
+        }
+#endif
+        snapshot.peak_rss_kb = PeakRssKb(snapshot.peak_rss_kb);
+        return snapshot;
+    }
+};
+
+// What one phase of a run cost.
+struct ResourceUsage
+{
+    double wall_sec = 0.0;
+    double cpu_sec = 0.0;
+    long peak_rss_kb = 0;  // high-water mark since the last ResetPeakRss, or of the whole process
+                           // where that is refused or unsupported
+};
+
+class Stopwatch
+{
+public:
+    Stopwatch() : start(ResourceSnapshot::Now()) {}
+
+    void Restart()
+    {
+        start = ResourceSnapshot::Now();
+    }
+
+    ResourceUsage Elapsed() const
+    {
+        const ResourceSnapshot now = ResourceSnapshot::Now();
+        ResourceUsage usage;
+        usage.wall_sec = std::chrono::duration<double>(now.wall - start.wall).count();
+        usage.cpu_sec = now.cpu_sec - start.cpu_sec;
+        usage.peak_rss_kb = now.peak_rss_kb;
+        return usage;
+    }
+
+    // wall seconds only, without the getrusage call
+    double Seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start.wall).count();
+    }
+
+private:
+    ResourceSnapshot start;
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph_io.h"
+
+// Vertices in degeneracy order: every vertex has at most `degeneracy` neighbours after it.
+struct DegeneracyOrder
+{
+    std::vector<int> order;
+    std::vector<int> position; // position[order[i]] == i
+    int degeneracy = 0;
+};
+
+// Repeatedly removes a vertex of minimum remaining degree (Batagelj-Zaversnik, O(n + m)).
+inline DegeneracyOrder ComputeDegeneracyOrder(const CsrGraph& graph)
+{
+    const int n = graph.n;
+    DegeneracyOrder result;
+    result.order.resize(n);
+    result.position.resize(n);
+
+    int max_degree = 0;
+    std::vector<int> degree(n);
+    for (int v = 0; v < n; ++v)
+    {
+        degree[v] = graph.Degree(v);
+        max_degree = std::max(max_degree, degree[v]);
+    }
+
+    // vertices sorted by degree, bucket_start[d] = first position of degree d
+    std::vector<int> bucket_start(max_degree + 2, 0);
+    for (int v = 0; v < n; ++v) ++bucket_start[degree[v] + 1];
+    for (int d = 1; d <= max_degree + 1; ++d) bucket_start[d] += bucket_start[d - 1];
+    std::vector<int>& sorted = result.order;
+    std::vector<int>& pos = result.position;
+    {
+        std::vector<int> next = bucket_start;
+        for (int v = 0; v < n; ++v)
+        {
+            pos[v] = next[degree[v]]++;
+            sorted[pos[v]] = v;
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        const int v = sorted[i];
+        result.degeneracy = std::max(result.degeneracy, degree[v]);
+        for (int u : graph.Neighbours(v))
+        {
+            if (pos[u] <= i || degree[u] <= degree[v])
+                continue;
+            // move u to the front of its bucket, then shrink the bucket past it
+            const int du = degree[u];
+            const int front = std::max(bucket_start[du], i + 1);
+            const int w = sorted[front];
+            if (w != u)
+            {
+                std::swap(sorted[front], sorted[pos[u]]);
+                pos[w] = pos[u];
+                pos[u] = front;
+            }
+            bucket_start[du] = front + 1;
+            --degree[u];
+        }
+    }
+    return result;
+}
+
+enum class VertexOrdering
+{
+    None,       // DIMACS file order
+    Degree,     // decreasing degree, hubs share cache lines
+    Degeneracy, // smallest-last removal order, the dense core ends up contiguous
+    Rcm,        // reverse Cuthill-McKee, neighbours get nearby ids
+};
+
+inline const char* VertexOrderingName(VertexOrdering ordering)
+{
+    switch (ordering)
+    {
+    case VertexOrdering::None: return "none";
+    case VertexOrdering::Degree: return "degree";
+    case VertexOrdering::Degeneracy: return "degeneracy";
+    case VertexOrdering::Rcm: return "rcm";
+    }
+    return "?";
+}
+
+inline bool ParseVertexOrdering(const std::string& name, VertexOrdering& ordering)
+{
+    for (VertexOrdering o : {VertexOrdering::None, VertexOrdering::Degree, VertexOrdering::Degeneracy, VertexOrdering::Rcm})
+    {
+        if (name == VertexOrderingName(o))
+        {
+            ordering = o;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Breadth-first from a minimum degree vertex of every component, neighbours in increasing
+// degree, then reversed.
+inline std::vector<int> ReverseCuthillMcKee(const CsrGraph& graph)
+{
+    const int n = graph.n;
+    std::vector<int> by_degree(n);
+    for (int v = 0; v < n; ++v) by_degree[v] = v;
+    std::stable_sort(by_degree.begin(), by_degree.end(),
+                     [&](int a, int b) { return graph.Degree(a) < graph.Degree(b); });
+
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<int> next;
+    for (int root : by_degree)
+    {
+        if (visited[root])
+            continue;
+        visited[root] = 1;
+        size_t head = order.size();
+        order.push_back(root);
+        for (; head < order.size(); ++head)
+        {
+            next.clear();
+            for (int u : graph.Neighbours(order[head]))
+            {
+                if (!visited[u])
+                {
+                    visited[u] = 1;
+                    next.push_back(u);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(),
+                             [&](int a, int b) { return graph.Degree(a) < graph.Degree(b); });
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Permutation of the vertex ids: new id i is the vertex original[i] of the input graph.
+struct VertexRelabeling
+{
+    std::vector<int> original; // new id -> original id
+    std::vector<int> relabeled; // original id -> new id
+
+    bool IsIdentity() const
+    {
+        return original.empty();
+    }
+
+    int ToOriginal(int v) const
+    {
+        return original.empty() ? v : original[v];
+    }
+
+    int ToRelabeled(int v) const
+    {
+        return relabeled.empty() ? v : relabeled[v];
+    }
+
+    std::vector<int> ToOriginal(const std::vector<int>& vertices) const
+    {
+        std::vector<int> result(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) result[i] = ToOriginal(vertices[i]);
+        return result;
+    }
+
+    // values indexed by original id -> the same values indexed by new id
+    template <class T>
+    std::vector<T> PermuteToRelabeled(const std::vector<T>& values) const
+    {
+        if (original.empty())
+            return values;
+        std::vector<T> result(values.size());
+        for (size_t i = 0; i < original.size(); ++i) result[i] = values[original[i]];
+        return result;
+    }
+};
+
+// Relabels `graph` in place so that vertex ids follow `ordering`, and returns the mapping
+// needed to report results in the original ids.
+inline VertexRelabeling RelabelGraph(CsrGraph& graph, VertexOrdering ordering)
+{
+    VertexRelabeling relabeling;
+    const int n = graph.n;
+    switch (ordering)
+    {
+    case VertexOrdering::None:
+        return relabeling;
+    case VertexOrdering::Degree:
+        relabeling.original.resize(n);
+        for (int v = 0; v < n; ++v) relabeling.original[v] = v;
+        std::stable_sort(relabeling.original.begin(), relabeling.original.end(),
+                         [&](int a, int b) { return graph.Degree(a) > graph.Degree(b); });
+        break;
+    case VertexOrdering::Degeneracy:
+        relabeling.original = ComputeDegeneracyOrder(graph).order;
+        break;
+    case VertexOrdering::Rcm:
+        relabeling.original = ReverseCuthillMcKee(graph);
+        break;
+    }
+
+    relabeling.relabeled.resize(n);
+    for (int i = 0; i < n; ++i) relabeling.relabeled[relabeling.original[i]] = i;
+
+    CsrGraph result;
+    result.n = n;
+    result.offsets.resize(static_cast<size_t>(n) + 1);
+    result.offsets[0] = 0;
+    for (int i = 0; i < n; ++i)
+        result.offsets[i + 1] = result.offsets[i] + static_cast<uint64_t>(graph.Degree(relabeling.original[i]));
+    result.adjacency.resize(result.offsets[n]);
+    ParallelFor(n, DefaultThreadCount(), [&](int i)
+    {
+        int* row = result.adjacency.data() + result.offsets[i];
+        int k = 0;
+        for (int u : graph.Neighbours(relabeling.original[i])) row[k++] = relabeling.relabeled[u];
+        std::sort(row, row + k);
+    });
+    graph = std::move(result);
+    return relabeling;
+}
@@ -10,561 +10,478 @@
 #include <iomanip>
 #include <cstdint>
 #include <limits>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <span>
+#include <functional>
+#include <filesystem>
+#include <charconv>
+
+#include "bnb_solver.h"
+#include "checkpoint.h"
+#include "graph_io.h"
+#include "maximal_cliques.h"
+#include "memory_placement.h"
+#include "neighbourhood_clique.h"
+#include "results_log.h"
+#include "run_options.h"
+#include "timing.h"
+#include "vertex_order.h"
+
 using namespace std;
 
 
-class MaxCliqueTabuSearch
+// Streams all maximal cliques of the graph as "<label>: <vertices>" lines; `largest` gets the
+// size of the largest one. The bitset B&B is not built, so this works on large sparse graphs.
+int64_t EnumerateMaximalCliques(const string& filepath, const string& label, int threads, VertexOrdering ordering,
+                                ostream& out, size_t& largest, ResourceUsage& parse, ResourceUsage& solve)
 {
-public:
-    static int GetRandom(int a, int b)
+    Stopwatch watch;
+    CsrGraph graph;
+    DimacsInfo info;
+    if (!ReadDimacsGraph(filepath, graph, info))
+        return 0;
+    const VertexRelabeling relabeling = RelabelGraph(graph, ordering);
+    parse = watch.Elapsed();
+
+    watch.Restart();
+    MaximalCliqueEnumerator enumerator(graph);
+    mutex out_mutex;
+    vector<size_t> thread_largest(max(1, threads), 0);
+    const int64_t cliques = enumerator.Run(threads, [&](const vector<int>& clique, int thread_id)
     {
-        static mt19937 generator;
-        uniform_int_distribution<int> uniform(a, b);
-        return uniform(generator);
-    }
+        thread_largest[thread_id] = max(thread_largest[thread_id], clique.size());
+        vector<int> sorted_clique = relabeling.ToOriginal(clique);
+        sort(sorted_clique.begin(), sorted_clique.end());
+        lock_guard<mutex> lock(out_mutex);
+        out << label << ":";
+        for (int v : sorted_clique) out << ' ' << v + 1;
+        out << '\n';
+    });
+    largest = *max_element(thread_largest.begin(), thread_largest.end());
+    solve = watch.Elapsed();
+    return cliques;
+}
 
-    void ReadGraphFile(string filename)
-    {
-        ifstream fin(filename);
-        string line;
-        int vertices = 0, edges = 0;
-        while (getline(fin, line))
-        {
-            if (line[0] == 'c')
-            {
-                continue;
-            }
+// A maximum clique by one small B&B per vertex over its later neighbours in degeneracy
+// order (common/neighbourhood_clique.h), in the file's vertex ids. Like
+// EnumerateMaximalCliques it never builds the n x n bitset. Returns false if the graph
+// cannot be read; is_clique is false if the result failed the edge check.
+bool SolveByDecomposition(const string& filepath, int threads, VertexOrdering ordering, ColoringStrategy strategy,
+                          double time_limit, vector<int>& clique, bool& is_clique, bool& timed_out,
+                          ResourceUsage& parse, ResourceUsage& solve)
+{
+    Stopwatch watch;
+    CsrGraph graph;
+    DimacsInfo info;
+    clique.clear();
+    is_clique = true;
+    timed_out = false;
+    if (!ReadDimacsGraph(filepath, graph, info))
+        return false;
+    const VertexRelabeling relabeling = RelabelGraph(graph, ordering);
+    parse = watch.Elapsed();
+
+    watch.Restart();
+    NeighbourhoodCliqueSolver solver(graph);
+    solver.SetTimeLimit(time_limit);
+    clique = solver.Run(threads, strategy);
+    timed_out = solver.TimedOut();
+    solve = watch.Elapsed();
+
+    for (size_t i = 0; i < clique.size() && is_clique; ++i)
+        for (size_t j = i + 1; j < clique.size() && is_clique; ++j)
+            is_clique = graph.HasEdge(clique[i], clique[j]);
+    clique = relabeling.ToOriginal(clique);
+    return true;
+}
 
-            stringstream line_input(line);
-            char command;
-            if (line[0] == 'p')
-            {
-                string type;
-                line_input >> command >> type >> vertices >> edges;
-                neighbour_sets.resize(vertices);
-                qco.resize(vertices);
-                index.resize(vertices, -1);
-                non_neighbours.resize(vertices);
-            }
-            else
-            {
-                int start, finish;
-                line_input >> command >> start >> finish;
-                // Edges in DIMACS file can be repeated, but it is not a problem for our sets
-                neighbour_sets[start - 1].insert(finish - 1);
-                neighbour_sets[finish - 1].insert(start - 1);
-            }
-        }
-        for (int i = 0; i < vertices; ++i)
+// Vertex subsets for --subsets, one per line as 1-based ids separated by spaces or commas;
+// empty lines and lines starting with '#' are skipped. lines[q] is the file line of query q.
+bool ReadVertexSubsets(const string& filename, vector<vector<int>>& subsets, vector<int>& lines)
+{
+    ifstream in(filename);
+    if (!in.is_open())
+    {
+        cerr << "Error: Cannot open file '" << filename << "'\n";
+        return false;
+    }
+    string line;
+    for (int number = 1; getline(in, line); ++number)
+    {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#')
+            continue;
+        replace(line.begin(), line.end(), ',', ' ');
+        stringstream ids(line);
+        subsets.emplace_back();
+        lines.push_back(number);
+        for (string token; ids >> token;)
         {
-            for (int j = 0; j < vertices; ++j)
+            int v = 0;
+            const auto [end, error] = from_chars(token.data(), token.data() + token.size(), v);
+            if (error != errc() || end != token.data() + token.size() || v < 1)
             {
-                if (neighbour_sets[i].count(j) == 0 && i != j)
-                    non_neighbours[i].insert(j);
+                cerr << "Error: Invalid vertex '" << token << "' on line " << number << " of file '" << filename << "'\n";
+                return false;
             }
+            subsets.back().push_back(v - 1);
         }
     }
+    return true;
+}
 
-    void RunSearch(int starts, int randomization)
+// false, with the line of the first offending query, if an id is not a vertex of an n-vertex graph
+bool CheckVertexSubsets(const vector<vector<int>>& subsets, const vector<int>& lines, int n, const string& filename)
+{
+    for (size_t q = 0; q < subsets.size(); ++q)
     {
-        for (int iter = 0; iter < starts; ++iter)
+        for (int v : subsets[q])
         {
-            ClearClique();
-            for (size_t i = 0; i < neighbour_sets.size(); ++i)
-            {
-                qco[i] = i;
-                index[i] = i;
-            }
-            RunInitialHeuristic(randomization);
-            c_border = q_border;
-            int swaps = 0;
-            while (swaps < 100)
-            {
-                if (! Move())
-                {
-                    if (! Swap1To1())
-                    {
-                        break;
-                    }
-                    else
-                    {
-                        ++swaps;
-                    }
-                }
-            }
-            if (q_border > best_clique.size())
+            if (v >= n)
             {
-                best_clique.clear();
-                for (int i = 0; i < q_border; ++i)
-                    best_clique.insert(qco[i]);
+                cerr << "Error: Vertex " << v + 1 << " on line " << lines[q] << " of file '" << filename
+                     << "' is out of range 1.." << n << '\n';
+                return false;
             }
         }
     }
+    return true;
+}
 
-    const unordered_set<int>& GetClique()
-    {
-        return best_clique;
-    }
+int main(int argc, char** argv)
+{
+    ios_base::sync_with_stdio(false);
+    cin.tie(nullptr);
 
-    bool Check()
+    RunOptions options;
+    if (!ParseRunOptions(argc, argv, options,
+                         {"coloring", "shallow-coloring", "shallow-depth", "checkpoint-dir", "checkpoint-interval", "weights",
+                          "enumerate", "cliques-out", "ordering", "maxsat", "cache-mb", "rows", "huge-pages", "subsets",
+                          "subsets-out"},
+                         {"resume", "hybrid", "symmetry", "decompose", "pin"}))
+        return 1;
+
+    // --coloring S for the whole search, or --shallow-coloring S --shallow-depth D on top of it
+    ColoringStrategy deep_coloring = ColoringStrategy::SequentialGreedy;
+    ColoringStrategy shallow_coloring = ColoringStrategy::SequentialGreedy;
+    int shallow_depth = 0;
+    if (!ParseColoringStrategy(options.Value("coloring", "greedy"), deep_coloring) ||
+        !ParseColoringStrategy(options.Value("shallow-coloring", "dsatur"), shallow_coloring))
     {
-        for (int i : best_clique)
-        {
-            for (int j : best_clique)
-            {
-                if (i != j && neighbour_sets[i].count(j) == 0)
-                {
-                    cout << "Returned subgraph is not a clique\n";
-                    return false;
-                }
-            }
-        }
-        return true;
+        cerr << "Error: Unknown coloring strategy (greedy, bitset-greedy, dsatur, rlf)\n";
+        return 1;
     }
+    if (options.values.count("shallow-coloring"))
+        shallow_depth = max(0, atoi(options.Value("shallow-depth", "2").c_str()));
 
-    void ClearClique()
+    // --ordering none|degree|degeneracy|rcm relabels vertices for cache locality
+    VertexOrdering ordering = VertexOrdering::None;
+    if (!ParseVertexOrdering(options.Value("ordering", "none"), ordering))
     {
-        best_clique.clear();
-        q_border = 0;
-        c_border = 0;
+        cerr << "Error: Unknown vertex ordering (none, degree, degeneracy, rcm)\n";
+        return 1;
     }
 
-private:
-    int ComputeTightness(int vertex)
+    // --checkpoint-dir D saves the search of every instance to D/<instance>.ckpt each
+    // --checkpoint-interval seconds (60 by default) and on Ctrl+C; --resume continues from
+    // the saved files, finished instances are answered from their final checkpoint
+    const string checkpoint_dir = options.Value("checkpoint-dir");
+    const double checkpoint_interval = max(0.1, atof(options.Value("checkpoint-interval", "60").c_str()));
+    if (!checkpoint_dir.empty())
+        filesystem::create_directories(checkpoint_dir);
+
+    // --weights S solves the maximum weight clique problem with the weights from: "dimacs" -
+    // the "n v w" lines of the graph file, "sidecar" - <graph>.w next to it, "mod200" - the
+    // usual benchmark weights (v mod 200) + 1, or any other value - that weight file
+    const string weight_source = options.Value("weights");
+
+    // --enumerate all streams every maximum clique, --enumerate K the K largest maximal
+    // cliques, --enumerate maximal all maximal cliques (Bron-Kerbosch, for large sparse
+    // graphs), to --cliques-out (cliques_bnb.txt), one "<instance>: <vertices>" line each
+    const string enumerate = options.Value("enumerate");
+    int64_t enumerate_k = 0;
+    if (!enumerate.empty() && enumerate != "all")
     {
-        int tightness = 0;
-        for (int i = 0; i < q_border; ++i)
+        enumerate_k = enumerate == "maximal" ? 0 : atoll(enumerate.c_str());
+        if ((enumerate != "maximal" && enumerate_k <= 0) || !weight_source.empty())
         {
-            if (neighbour_sets[qco[i]].count(vertex) == 0)
-                ++tightness;
+            cerr << "Error: --enumerate takes 'all', 'maximal' or a positive count, the last two only without weights\n";
+            return 1;
         }
-        return tightness;
     }
-
-    void SwapVertices(int vertex, int border)
+    if (!enumerate.empty() && !checkpoint_dir.empty())
     {
-        int vertex_at_border = qco[border];
-        swap(qco[index[vertex]], qco[border]);
-        swap(index[vertex], index[vertex_at_border]);
+        cerr << "Error: --enumerate cannot be combined with --checkpoint-dir\n";
+        return 1;
     }
-
-    void InsertToClique(int i)
+    // --maxsat M refines the coloring bound by MaxSAT reasoning where it is at most M above
+    // the incumbent (1-3 is sensible, 0 is off); not with --weights or --checkpoint-dir
+    const int maxsat_margin = max(0, atoi(options.Value("maxsat", "0").c_str()));
+    if (maxsat_margin > 0 && (!weight_source.empty() || !checkpoint_dir.empty()))
     {
-        for (int j : non_neighbours[i])
-        {
-            if (ComputeTightness(j) == 0)
-            {
-                --c_border;
-                SwapVertices(j, c_border);
-            }
-        }
-        SwapVertices(i, q_border);
-        ++q_border;
+        cerr << "Error: --maxsat cannot be combined with --weights or --checkpoint-dir\n";
+        return 1;
     }
-
-    void RemoveFromClique(int k)
+    // --symmetry branches on one vertex per orbit at the root (for hamming, johnson, keller, MANN)
+    if (options.Flag("symmetry") && !checkpoint_dir.empty())
     {
-        for (int j : non_neighbours[k])
-        {
-            if (ComputeTightness(j) == 1)
-            {
-                SwapVertices(j, c_border);
-                c_border++;
-            }
-        }
-        --q_border;
-        SwapVertices(k, q_border);
+        cerr << "Error: --symmetry cannot be combined with --checkpoint-dir\n";
+        return 1;
     }
-
-    bool Swap1To1()
+    // --cache-mb N shares the bounds of finished subproblems between branches in a table of
+    // about N MB (0, the default, turns it off); helps on symmetric graphs
+    const size_t cache_mb = static_cast<size_t>(max(0, atoi(options.Value("cache-mb", "0").c_str())));
+    // --rows auto|dense: compressed adjacency rows where they are much smaller (auto, the
+    // default), or dense bitsets for every vertex
+    const string rows = options.Value("rows", "auto");
+    if (rows != "auto" && rows != "dense")
     {
-        int st = GetRandom(0, q_border - 1);
-        for (int counter = 0; counter < q_border; ++counter)
-        {
-            int vertex_index = (counter + st) % q_border;
-            int vertex = qco[vertex_index];
-            vector<int> L;
-            for (int i : non_neighbours[vertex])
-            {
-                if (ComputeTightness(i) == 1)
-                {
-                    L.push_back(i);
-                }
-            }
-            if (L.empty())
-                continue;
-            int index_in_l = GetRandom(0, L.size() - 1);
-            int change = L[index_in_l];
-            RemoveFromClique(vertex);
-            InsertToClique(change);
-            return true;
-        }
-        return false;
+        cerr << "Error: Unknown row layout (auto, dense)\n";
+        return 1;
     }
-
-    bool Move()
+    // --huge-pages off|thp|hugetlb: page size of the adjacency rows from 2 MB up, transparent
+    // huge pages by default; --pin binds worker threads to CPUs and copies the rows to every
+    // NUMA node
+    HugePages huge_pages = HugePages::Transparent;
+    if (!ParseHugePages(options.Value("huge-pages", "thp"), huge_pages))
     {
-        if (c_border == q_border)
-            return false;
-        int index_in_qco = GetRandom(q_border, c_border - 1);
-        int vertex = qco[index_in_qco];
-        InsertToClique(vertex);
-        return true;
+        cerr << "Error: Unknown huge page mode (off, thp, hugetlb)\n";
+        return 1;
     }
-
-    void RunInitialHeuristic(int randomization)
+    SetHugePages(huge_pages);
+    // --decompose solves one small B&B per vertex instead of one over an n x n bitset, for
+    // large sparse graphs; only the plain unweighted problem
+    const bool decompose = options.Flag("decompose");
+    if (decompose && (!weight_source.empty() || !enumerate.empty() || !checkpoint_dir.empty()))
     {
-        static mt19937 generator;
-        vector<int> candidates(neighbour_sets.size());
-        for (size_t i = 0; i < neighbour_sets.size(); ++i)
-        {
-            candidates[i] = i;
-        }
-        shuffle(candidates.begin(), candidates.end(), generator);
-        while (! candidates.empty())
+        cerr << "Error: --decompose cannot be combined with --weights, --enumerate or --checkpoint-dir\n";
+        return 1;
+    }
+    // --subsets F answers one query per line of F: a maximum clique of the subgraph induced
+    // by those vertices, on the graph loaded once (--time-limit applies to each query). The
+    // queries are shared between --threads threads and every answer is written to
+    // --subsets-out (subsets_bnb.txt) when it is found, as "<instance> #<query>: <vertices>"
+    vector<vector<int>> subsets;
+    vector<int> subset_lines;
+    const string subsets_file = options.Value("subsets");
+    if (!subsets_file.empty())
+    {
+        if (!enumerate.empty() || decompose || !checkpoint_dir.empty())
         {
-            int last = candidates.size() - 1;
-            int rnd = GetRandom(0, min(randomization - 1, last));
-            int vertex = candidates[rnd];
-            SwapVertices(vertex, q_border);
-            ++q_border;
-            for (int c = 0; c < candidates.size(); ++c)
-            {
-                int candidate = candidates[c];
-                if (neighbour_sets[vertex].count(candidate) == 0)
-                {
-                    swap(candidates[c], candidates[candidates.size() - 1]);
-                    candidates.pop_back();
-                    --c;
-                }
-            }
-            shuffle(candidates.begin(), candidates.end(), generator);
+            cerr << "Error: --subsets cannot be combined with --enumerate, --decompose or --checkpoint-dir\n";
+            return 1;
         }
+        if (!ReadVertexSubsets(subsets_file, subsets, subset_lines))
+            return 1;
     }
-
-private:
-    vector<unordered_set<int>> neighbour_sets;
-    vector<unordered_set<int>> non_neighbours;
-    unordered_set<int> best_clique;
-    vector<int> qco;
-    vector<int> index;
-    int q_border = 0;
-    int c_border = 0;
-};
-
-
-class BnBSolver
-{
-public:
-    void ReadGraphFile(string filename)
+    ofstream cliques_out;
+    if (!enumerate.empty())
+        cliques_out.open(options.Value("cliques-out", "cliques_bnb.txt"));
+    ofstream subsets_out;
+    if (!subsets_file.empty())
+        subsets_out.open(options.Value("subsets-out", "subsets_bnb.txt"));
+
+    const vector<InstanceFile> files = ListInstances(options, "task4_input", {
+        "brock200_1.clq", "brock200_2.clq", "brock200_3.clq", "brock200_4.clq",
+        "C125.9.clq", "gen200_p0.9_44.clq", "gen200_p0.9_55.clq",
+        "hamming8-4.clq", "johnson16-2-4.clq", "johnson8-2-4.clq",
+        "keller4.clq", "MANN_a27.clq", "MANN_a9.clq",
+        "p_hat1000-1.clq", "p_hat1500-1.clq",
+        "p_hat300-3.clq", "san1000.clq", "sanr200_0.9.clq"
+    });
+    ofstream fout(options.output.empty() ? "clique_bnb.csv" : options.output);
+    fout << "File; Clique" << (weight_source.empty() ? "" : "; Weight")
+         << (enumerate.empty() && subsets_file.empty() ? "" : "; Cliques")
+         << "; Time (sec); CPU (sec); Parse (sec); Peak RSS (KB)\n";
+    for (const InstanceFile& instance : files)
     {
-        file = filename;
-        ifstream fin(filename);
-        if (!fin)
-            return;
-
-        int vert = 0, edges = 0;
-        char tag = 0;
-        while (fin >> tag)
+        const string& file = instance.name;
+        const string& filepath = instance.path;
+        ResetPeakRss(); // Peak RSS of this instance only
+        BnBSolver<> problem(options.seed);
+        if (enumerate == "maximal")
+        {
+            size_t largest = 0;
+            ResourceUsage parse, solve;
+            const int64_t cliques = EnumerateMaximalCliques(filepath, file, options.threads, ordering, cliques_out, largest,
+                                                            parse, solve);
+            fout << file << "; " << largest << "; " << cliques << "; " << fixed << setprecision(6) << solve.wall_sec << "; "
+                 << solve.cpu_sec << "; " << parse.wall_sec << "; " << solve.peak_rss_kb << '\n';
+            cout << file << ", result - " << largest << ", cliques - " << cliques << ", time - "
+                 << fixed << setprecision(6) << solve.wall_sec << ", parse - " << parse.wall_sec << '\n';
+            AppendRunRecord(options, MakeRunRecord(options, "lab4-maximal", file, parse, solve, static_cast<int64_t>(largest)));
+            continue;
+        }
+        if (decompose)
         {
-            if (tag == 'c')
+            bool timed_out = false;
+            bool is_clique = true;
+            vector<int> clique;
+            ResourceUsage parse, solve;
+            if (!SolveByDecomposition(filepath, options.threads, ordering, deep_coloring, options.time_limit, clique,
+                                      is_clique, timed_out, parse, solve))
             {
-                fin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cerr << "Error: Failed to read graph from file '" << filepath << "'. Skipping...\n";
                 continue;
             }
-            if (tag == 'p')
+            if (!is_clique)
             {
-                string type;
-                fin >> type >> vert >> edges;
-                n = vert;
-                words = (n + 63) / 64;
-                adj.assign(static_cast<size_t>(n) * static_cast<size_t>(words), 0ULL);
-                degree.assign(n, 0);
-                continue;
+                cout << "*** WARNING: incorrect clique ***\n";
+                fout << "*** WARNING: incorrect clique ***\n";
             }
-            if (tag == 'e')
-            {
-                int st = 0, fn = 0;
-                fin >> st >> fn;
-                --st; --fn;
-                if (st < 0 || fn < 0 || st >= n || fn >= n || st == fn)
-                    continue;
-                if (!IsAdjacent(st, fn))
-                {
-                    SetEdge(st, fn);
-                    SetEdge(fn, st);
-                    ++degree[st];
-                    ++degree[fn];
-                }
+            fout << file << "; " << clique.size() << "; " << fixed << setprecision(6) << solve.wall_sec << "; "
+                 << solve.cpu_sec << "; " << parse.wall_sec << "; " << solve.peak_rss_kb << '\n';
+            cout << file << ", result - " << clique.size() << ", time - " << fixed << setprecision(6) << solve.wall_sec
+                 << ", parse - " << parse.wall_sec << (timed_out ? ", time limit reached" : "") << '\n';
+            AppendRunRecord(options, MakeRunRecord(options, "lab4", file, parse, solve, static_cast<int64_t>(clique.size())));
+            continue;
+        }
+        Stopwatch parse_watch;
+        problem.ForceDenseRows(rows == "dense");
+        problem.ReadGraphFile(filepath, ordering);
+        problem.SetColoring(shallow_coloring, shallow_depth, deep_coloring);
+        // --hybrid runs a tabu search thread that shares the incumbent with the B&B
+        problem.EnableHybrid(options.Flag("hybrid"));
+        problem.SetMaxSatMargin(maxsat_margin);
+        problem.SetCacheSize(cache_mb);
+        problem.EnableSymmetry(options.Flag("symmetry"));
+        problem.EnablePinning(options.Flag("pin"));
+        problem.ClearClique();
+        if (!weight_source.empty())
+        {
+            const int n = problem.VertexCount();
+            vector<int64_t> weights(n);
+            bool loaded = true;
+            if (weight_source == "dimacs")
+                loaded = ReadDimacsWeights(filepath, n, weights);
+            else if (weight_source == "sidecar")
+                loaded = ReadWeightsFile(filepath + ".w", n, weights);
+            else if (weight_source == "mod200")
+                for (int v = 0; v < n; ++v) weights[v] = (v + 1) % 200 + 1;
+            else
+                loaded = ReadWeightsFile(weight_source, n, weights);
+            string weight_error;
+            if (loaded && !problem.SetWeights(weights, weight_error))
+                cerr << "Error: " << weight_error << '\n';
+            if (!loaded || !weight_error.empty())
                 continue;
-            }
-
-            fin.ignore(numeric_limits<streamsize>::max(), '\n');
         }
-    }
-
-    void RunBnB()
-    {
-        // Fast initial lower bound
-        InitBestCliqueGreedy(8, 10);
-
-        vector<int> candidates(n);
-        for (int i = 0; i < n; ++i) candidates[i] = i;
-        sort(candidates.begin(), candidates.end(),
-             [&](int a, int b) { return degree[a] > degree[b]; });
-
-        cur_clique.clear();
-        Expand(candidates);
-    }
-
-    const unordered_set<int>& GetClique()
-    {
-        return best_clique_set;
-    }
-
-    bool Check()
-    {
-        for (int i : best_clique_set)
+        if (!subsets_file.empty())
         {
-            for (int j : best_clique_set)
+            if (!CheckVertexSubsets(subsets, subset_lines, problem.VertexCount(), subsets_file))
+                continue;
+            const ResourceUsage parse = parse_watch.Elapsed();
+            Stopwatch solve_watch;
+            size_t largest = 0;
+            int best_weight = 0;
+            int64_t cut_short = 0;
+            problem.SolveSubsets(subsets, options.threads, options.time_limit, [&](const BnBSolver<>::SubsetResult& result)
             {
-                if (i != j && !IsAdjacent(i, j))
-                {
-                    cout << "Returned subgraph is not clique\n";
-                    return false;
-                }
+                largest = max(largest, result.clique.size());
+                best_weight = max(best_weight, result.weight);
+                cut_short += !result.optimal;
+                subsets_out << file << " #" << result.query + 1 << ":";
+                for (int v : result.clique) subsets_out << ' ' << v + 1;
+                subsets_out << (result.optimal ? "" : " (time limit)") << endl;
+            });
+            const ResourceUsage solve = solve_watch.Elapsed();
+            fout << file << "; " << largest;
+            cout << file << ", largest - " << largest;
+            if (!weight_source.empty())
+            {
+                fout << "; " << best_weight;
+                cout << ", weight - " << best_weight;
             }
+            fout << "; " << subsets.size() << "; " << fixed << setprecision(6) << solve.wall_sec << "; " << solve.cpu_sec
+                 << "; " << parse.wall_sec << "; " << solve.peak_rss_kb << '\n';
+            cout << ", queries - " << subsets.size() << ", time - " << fixed << setprecision(6) << solve.wall_sec
+                 << ", parse - " << parse.wall_sec << (cut_short > 0 ? ", time limit reached" : "") << '\n';
+            const int64_t size = weight_source.empty() ? static_cast<int64_t>(largest) : best_weight;
+            AppendRunRecord(options, MakeRunRecord(options, "lab4-subsets", file, parse, solve, size));
+            continue;
         }
-        return true;
-    }
-
-    void ClearClique()
-    {
-        best_clique_set.clear();
-        best_clique_vec.clear();
-        cur_clique.clear();
-        best_size = 0;
-    }
-
-private:
-    inline const uint64_t* AdjRow(int u) const
-    {
-        return adj.data() + static_cast<size_t>(u) * static_cast<size_t>(words);
-    }
-
-    inline uint64_t* AdjRow(int u)
-    {
-        return adj.data() + static_cast<size_t>(u) * static_cast<size_t>(words);
-    }
-
-    inline bool IsAdjacent(int u, int v) const
-    {
-        const uint64_t mask = 1ULL << (v & 63);
-        return (AdjRow(u)[v >> 6] & mask) != 0ULL;
-    }
-
-    inline void SetEdge(int u, int v)
-    {
-        AdjRow(u)[v >> 6] |= (1ULL << (v & 63));
-    }
-
-    static inline void OrEq(uint64_t* a, const uint64_t* b, int w)
-    {
-        for (int i = 0; i < w; ++i) a[i] |= b[i];
-    }
-
-    static inline void SetBit(uint64_t* bs, int v)
-    {
-        bs[v >> 6] |= (1ULL << (v & 63));
-    }
-
-    static inline bool TestBit(const uint64_t* bs, int v)
-    {
-        return (bs[v >> 6] & (1ULL << (v & 63))) != 0ULL;
-    }
-
-    void ColorSort(const vector<int>& candidates, vector<int>& order, vector<int>& bounds) const
-    {
-        order.clear();
-        bounds.clear();
-        order.reserve(candidates.size());
-        bounds.reserve(candidates.size());
-
-        vector<int> U = candidates;
-        int color = 0;
-        vector<uint64_t> forbidden(static_cast<size_t>(words), 0ULL);
-        vector<int> nextU;
-        nextU.reserve(U.size());
-        while (!U.empty())
+        if (!checkpoint_dir.empty())
         {
-            ++color;
-            fill(forbidden.begin(), forbidden.end(), 0ULL);
-            nextU.clear();
-
-            for (int v : U)
-            {
-                if (!TestBit(forbidden.data(), v))
-                {
-                    order.push_back(v);
-                    bounds.push_back(color);
-                    SetBit(forbidden.data(), v);
-                    OrEq(forbidden.data(), AdjRow(v), words);
-                }
-                else
-                {
-                    nextU.push_back(v);
-                }
-            }
-            U.swap(nextU);
+            const string checkpoint = (filesystem::path(checkpoint_dir) /
+                                       (filesystem::path(file).filename().string() + ".ckpt")).string();
+            if (options.Flag("resume") && filesystem::exists(checkpoint) &&
+                !problem.LoadCheckpoint(checkpoint, options.deterministic))
+                continue;
+            problem.EnableCheckpoint(checkpoint, checkpoint_interval);
         }
-    }
-
-    void Expand(const vector<int>& candidates)
-    {
-        if (candidates.empty())
+        problem.SetTimeLimit(options.time_limit);
+        const ResourceUsage parse = parse_watch.Elapsed();
+        Stopwatch solve_watch;
+        int64_t cliques = 0;
+        if (enumerate.empty())
         {
-            if (static_cast<int>(cur_clique.size()) > best_size)
-            {
-                best_size = static_cast<int>(cur_clique.size());
-                best_clique_vec = cur_clique;
-                best_clique_set.clear();
-                for (int v : best_clique_vec) best_clique_set.insert(v);
-            }
-            return;
+            problem.RunBnB(options.threads, options.deterministic);
         }
-
-        vector<int> order;
-        vector<int> bounds;
-        ColorSort(candidates, order, bounds);
-
-        for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i)
+        else
         {
-            if (static_cast<int>(cur_clique.size()) + bounds[i] <= best_size)
-                return; // since bounds are nondecreasing for prefixes
-
-            const int v = order[i];
-            const uint64_t* row_v = AdjRow(v);
-            vector<int> new_candidates;
-            new_candidates.reserve(static_cast<size_t>(i));
-            for (int j = 0; j < i; ++j)
+            cliques = problem.Enumerate(options.threads, options.deterministic, enumerate_k,
+                                        [&](const vector<int>& clique)
             {
-                const int u = order[j];
-                if ((row_v[u >> 6] & (1ULL << (u & 63))) != 0ULL) new_candidates.push_back(u);
-            }
-
-            cur_clique.push_back(v);
-            Expand(new_candidates);
-            cur_clique.pop_back();
+                vector<int> sorted_clique = clique;
+                sort(sorted_clique.begin(), sorted_clique.end());
+                cliques_out << file << ":";
+                for (int v : sorted_clique) cliques_out << ' ' << v + 1;
+                cliques_out << '\n';
+            });
         }
-    }
-
-private:
-    void InitBestCliqueGreedy(int starts, int rcl)
-    {
-        if (n <= 0) return;
-        if (starts <= 0) starts = 1;
-        if (rcl <= 0) rcl = 1;
-
-        vector<int> base(n);
-        for (int i = 0; i < n; ++i) base[i] = i;
-        sort(base.begin(), base.end(), [&](int a, int b) { return degree[a] > degree[b]; });
-
-        static mt19937 gen(1234567);
-
-        for (int s = 0; s < starts; ++s)
+        const ResourceUsage solve = solve_watch.Elapsed();
+        if (problem.Interrupted())
         {
-            vector<int> cand = base;
-            vector<int> clique;
-            clique.reserve(64);
-
-            while (!cand.empty())
-            {
-                const int last = static_cast<int>(cand.size()) - 1;
-                const int take = min(rcl - 1, last);
-                uniform_int_distribution<int> dist(0, take);
-                const int pick_idx = dist(gen);
-                const int v = cand[pick_idx];
-                const uint64_t* row_v = AdjRow(v);
-
-                clique.push_back(v);
-
-                vector<int> next;
-                next.reserve(static_cast<size_t>(last));
-                for (int i = 0; i < static_cast<int>(cand.size()); ++i)
-                {
-                    if (i == pick_idx) continue;
-                    const int u = cand[i];
-                    if ((row_v[u >> 6] & (1ULL << (u & 63))) != 0ULL) next.push_back(u);
-                }
-                cand.swap(next);
-            }
-
-            if (static_cast<int>(clique.size()) > best_size)
-            {
-                best_size = static_cast<int>(clique.size());
-                best_clique_vec = clique;
-                best_clique_set.clear();
-                for (int v : best_clique_vec) best_clique_set.insert(v);
-            }
+            cout << file << ", interrupted, progress saved to " << checkpoint_dir << '\n';
+            break;
         }
-    }
-
-    int n = 0;
-    int words = 0;
-    vector<uint64_t> adj;
-    vector<int> degree;
-
-    int best_size = 0;
-    vector<int> best_clique_vec;
-    vector<int> cur_clique;
-    unordered_set<int> best_clique_set;
-
-    string file;
-};
-
-int main(int argc, char** argv)
-{
-    ios_base::sync_with_stdio(false);
-    cin.tie(nullptr);
-
-    vector<string> files;
-    if (argc > 1)
-    {
-        for (int i = 1; i < argc; ++i) files.emplace_back(argv[i]);
-    }
-    else
-    {
-        files = {
-            "brock200_1.clq", "brock200_2.clq", "brock200_3.clq", "brock200_4.clq",
-            "C125.9.clq", "gen200_p0.9_44.clq", "gen200_p0.9_55.clq",
-            "hamming8-4.clq", "johnson16-2-4.clq", "johnson8-2-4.clq",
-            "keller4.clq", "MANN_a27.clq", "MANN_a9.clq",
-            "p_hat1000-1.clq", "p_hat1500-1.clq",
-            "p_hat300-3.clq", "san1000.clq", "sanr200_0.9.clq"
-        };
-    }
-    ofstream fout("clique_bnb.csv");
-    fout << "File; Clique; Time (sec)\n";
-    for (string file : files)
-    {
-        BnBSolver problem;
-        string filepath = file;
-        if (filepath.find('/') == string::npos && filepath.find('\\') == string::npos)
-            filepath = "task4_input/" + filepath;
-        problem.ReadGraphFile(filepath);
-        problem.ClearClique();
-        clock_t start = clock();
-        problem.RunBnB();
         if (! problem.Check())
         {
             cout << "*** WARNING: incorrect clique ***\n";
             fout << "*** WARNING: incorrect clique ***\n";
         }
 
-        double time_sec = double(clock() - start) / CLOCKS_PER_SEC;
+        // a resumed search also counts the time spent before its checkpoint
+        const double time_sec = solve.wall_sec + problem.PreviousSeconds();
 
-        fout << file << "; " << problem.GetClique().size() << "; " << fixed << setprecision(6) << time_sec << '\n';
-        cout << file << ", result - " << problem.GetClique().size() << ", time - " << fixed << setprecision(6) << time_sec << '\n';
+        fout << file << "; " << problem.GetClique().size();
+        cout << file << ", result - " << problem.GetClique().size();
+        if (!weight_source.empty())
+        {
+            fout << "; " << problem.GetWeight();
+            cout << ", weight - " << problem.GetWeight();
+        }
+        if (!enumerate.empty())
+        {
+            fout << "; " << cliques;
+            cout << ", cliques - " << cliques;
+        }
+        fout << "; " << fixed << setprecision(6) << time_sec << "; " << solve.cpu_sec << "; " << parse.wall_sec << "; "
+             << solve.peak_rss_kb << '\n';
+        cout << ", time - " << fixed << setprecision(6) << time_sec << ", parse - " << parse.wall_sec
+             << ", nodes - " << problem.Nodes();
+        if (problem.DenseRows() < problem.VertexCount())
+            cout << ", dense rows - " << problem.DenseRows() << "/" << problem.VertexCount() << ", row memory - "
+                 << setprecision(1) << problem.RowBytes() / 1048576.0 << " MB";
+        if (options.Flag("symmetry"))
+            cout << ", orbits - " << problem.OrbitCount() << ", skipped branches - " << problem.SkippedBranches();
+        if (problem.CacheEnabled())
+        {
+            const auto stats = problem.GetCacheStats();
+            cout << ", cache hits - " << stats.hits << "/" << stats.lookups << " (" << setprecision(1)
+                 << (stats.lookups > 0 ? 100.0 * stats.hits / stats.lookups : 0.0) << "%), cutoffs - " << stats.cutoffs
+                 << ", evictions - " << stats.evictions;
+        }
+        cout << (problem.TimedOut() ? ", time limit reached" : "") << '\n';
+        // modes with a different objective are kept apart in the log
+        const string program = string("lab4") + (weight_source.empty() ? "" : "-weighted") +
+                               (enumerate.empty() ? "" : "-enumerate");
+        const int64_t size = weight_source.empty() ? static_cast<int64_t>(problem.GetClique().size()) : problem.GetWeight();
+        AppendRunRecord(options, MakeRunRecord(options, program, file, parse, solve, size));
     }
     
     return 0;
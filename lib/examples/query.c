@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clique_solvers.h"
+
+/*
+ * Answers queries on a graph that lives in memory: a 5-cycle with the chord 0-2, held by
+ * the caller as CSR arrays and borrowed by the library, or a DIMACS file given as argument.
+ */
+
+static void PrintSubsetAnswer(void* context, int64_t query, const int32_t* clique, const cs_clique_result* result)
+{
+    (void)context;
+    printf("subset %lld: clique %d:", (long long)query + 1, result->size);
+    for (int32_t i = 0; i < result->size; ++i) printf(" %d", clique[i] + 1);
+    printf("\n");
+}
+
+static int Fail(const char* what, int status)
+{
+    fprintf(stderr, "Error: %s: %s\n", what, cs_status_string(status));
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    static const uint64_t offsets[] = {0, 3, 5, 8, 10, 12};
+    static const int32_t adjacency[] = {1, 2, 4, 0, 2, 0, 1, 3, 2, 4, 0, 3};
+
+    cs_graph* graph = NULL;
+    int status = argc > 1 ? cs_graph_read_dimacs(argv[1], &graph) : cs_graph_borrow_csr(5, offsets, adjacency, &graph);
+    if (status != CS_OK)
+        return Fail("graph", status);
+    if ((status = cs_graph_check(graph)) != CS_OK)
+        return Fail("check", status);
+
+    const int32_t n = cs_graph_vertex_count(graph);
+    int32_t* buffer = malloc(sizeof(int32_t) * (n > 0 ? n : 1));
+    printf("abi %d, %d vertices, %lld edges\n", cs_abi_version(), n, (long long)cs_graph_edge_count(graph));
+
+    int32_t colors = 0;
+    if ((status = cs_color(graph, NULL, buffer, &colors)) != CS_OK)
+        return Fail("coloring", status);
+    printf("colors: %d\n", colors);
+
+    cs_clique_options options;
+    cs_clique_options_init(&options);
+    options.deterministic = 1;
+    cs_clique_result result;
+    if ((status = cs_clique_grasp(graph, &options, buffer, &result)) != CS_OK)
+        return Fail("grasp", status);
+    printf("grasp clique: %d\n", result.size);
+
+    if ((status = cs_clique_bnb(graph, &options, buffer, &result)) != CS_OK)
+        return Fail("bnb", status);
+    printf("maximum clique: %d (%s, %llu nodes):", result.size, result.optimal ? "optimal" : "time limit",
+           (unsigned long long)result.nodes);
+    for (int32_t i = 0; i < result.size; ++i) printf(" %d", buffer[i] + 1);
+    printf("\n");
+
+    /* the same graph restricted to a few vertex sets, ids out of range are rejected */
+    const int32_t first[] = {0, 1, 3};
+    const int32_t second[] = {1, 2, 3, 4};
+    const int32_t* subsets[] = {first, second};
+    const int32_t sizes[] = {n >= 4 ? 3 : 0, n >= 5 ? 4 : 0};
+    if ((status = cs_clique_bnb_subsets(graph, &options, subsets, sizes, 2, PrintSubsetAnswer, NULL)) != CS_OK)
+        return Fail("subsets", status);
+
+    free(buffer);
+    cs_graph_free(graph);
+    return 0;
+}
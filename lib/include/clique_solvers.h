@@ -0,0 +1,118 @@
+#ifndef CLIQUE_SOLVERS_H
+#define CLIQUE_SOLVERS_H
+
+/*
+ * C interface of the solvers: the week1 coloring, GRASP (lab2), tabu search (lab3) and the
+ * exact branch and bound (lab4) on graphs held in memory, so that a service can answer
+ * queries in-process without writing or parsing DIMACS files.
+ *
+ * Vertices are 0-based. A graph is read-only once made, and every solver call only reads
+ * it, so one graph may serve concurrent calls from several threads. Calls return CS_OK or
+ * a negative status; cs_status_string describes it.
+ *
+ * Later versions only add functions and append fields to cs_clique_options, whose `size`
+ * tells the library which fields the caller knows about.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define CS_API __declspec(dllexport)
+#else
+#define CS_API __attribute__((visibility("default")))
+#endif
+
+#define CS_ABI_VERSION 1
+
+enum
+{
+    CS_OK = 0,
+    CS_INVALID_ARGUMENT = -1,
+    CS_INVALID_GRAPH = -2,
+    CS_IO_ERROR = -3,
+    CS_OUT_OF_MEMORY = -4,
+    CS_INTERNAL_ERROR = -5,
+};
+
+typedef struct cs_graph cs_graph;
+
+typedef struct cs_clique_options
+{
+    uint32_t size;          /* sizeof(cs_clique_options), set by cs_clique_options_init */
+    uint64_t seed;
+    int32_t threads;        /* worker threads, 1 by default */
+    int32_t deterministic;  /* nonzero: the result does not depend on thread scheduling */
+    double time_limit;      /* seconds, 0 for none */
+    int32_t iterations;     /* GRASP and tabu, 0 for the drivers' defaults */
+    int32_t randomization;  /* GRASP candidate list or tabu tournament size, 0 likewise */
+    const int64_t* weights; /* branch and bound: n positive vertex weights summing to less
+                               than 2^31 (else CS_INVALID_ARGUMENT), NULL for none */
+} cs_clique_options;
+
+typedef struct cs_clique_result
+{
+    int32_t size;      /* vertices written to the clique buffer */
+    int64_t weight;    /* total weight, equal to size without weights */
+    int32_t optimal;   /* branch and bound finished within the time limit */
+    uint64_t nodes;    /* branch and bound nodes searched */
+} cs_clique_result;
+
+CS_API int cs_abi_version(void);
+CS_API const char* cs_status_string(int status);
+
+/*
+ * The caller's compressed sparse row arrays, used in place and never copied: the
+ * neighbours of v are adjacency[offsets[v] .. offsets[v + 1]), sorted, without duplicates
+ * or self-loops, and every edge is listed in both directions. Both arrays must outlive the
+ * graph. cs_graph_check verifies this layout in O(m log d).
+ */
+CS_API int cs_graph_borrow_csr(int32_t n, const uint64_t* offsets, const int32_t* adjacency, cs_graph** graph);
+
+/* A graph of its own from `edge_count` pairs (edges[2i], edges[2i + 1]); duplicates, both
+ * directions and self-loops are allowed and dropped. */
+CS_API int cs_graph_from_edges(int32_t n, const int32_t* edges, int64_t edge_count, cs_graph** graph);
+
+CS_API int cs_graph_read_dimacs(const char* path, cs_graph** graph);
+CS_API int cs_graph_check(const cs_graph* graph);
+CS_API int32_t cs_graph_vertex_count(const cs_graph* graph);
+CS_API int64_t cs_graph_edge_count(const cs_graph* graph);
+CS_API void cs_graph_free(cs_graph* graph);
+
+/*
+ * Proper coloring into colors[0..n), colors 1..*color_count. strategy NULL: the week1
+ * DSATUR; otherwise a ColoringEngine strategy ("greedy", "bitset-greedy", "dsatur", "rlf").
+ */
+CS_API int cs_color(const cs_graph* graph, const char* strategy, int32_t* colors, int32_t* color_count);
+
+CS_API void cs_clique_options_init(cs_clique_options* options);
+
+/* A clique into clique[0..n); result->size tells how many vertices were written. */
+CS_API int cs_clique_grasp(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                           cs_clique_result* result);
+CS_API int cs_clique_tabu(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                          cs_clique_result* result);
+CS_API int cs_clique_bnb(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                         cs_clique_result* result);
+
+/*
+ * Maximum (weight) clique of the subgraph induced by each of `count` vertex subsets,
+ * subsets[q][0 .. sizes[q]), on the graph as it is; duplicates are dropped. time_limit
+ * applies to each query and `threads` threads share the queries. Every answer goes to
+ * `callback` as soon as it is found, one call at a time and in no particular order; the
+ * clique array is sorted and only valid during the call. Returns once all were answered.
+ */
+typedef void (*cs_subset_callback)(void* context, int64_t query, const int32_t* clique,
+                                   const cs_clique_result* result);
+CS_API int cs_clique_bnb_subsets(const cs_graph* graph, const cs_clique_options* options,
+                                 const int32_t* const* subsets, const int32_t* sizes, int64_t count,
+                                 cs_subset_callback callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,318 @@
+#include "clique_solvers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bnb_solver.h"
+#include "coloring_problem.h"
+#include "grasp_clique.h"
+#include "graph_io.h"
+#include "tabu_search.h"
+
+static_assert(sizeof(int) == sizeof(int32_t), "CsrGraph adjacency must be int32_t");
+
+// `view` is what the solvers get: always a borrowed CsrGraph, over the caller's arrays or
+// over `owned`, so handing it to a solver copies two pointers instead of the adjacency.
+struct cs_graph
+{
+    CsrGraph owned;
+    CsrGraph view;
+    const uint64_t* offsets = nullptr; // the offsets `view` reads
+};
+
+namespace
+{
+    // keeps C++ exceptions from crossing the C boundary
+    template <class Body>
+    int Guarded(Body&& body)
+    {
+        try
+        {
+            return body();
+        }
+        catch (const std::bad_alloc&)
+        {
+            return CS_OUT_OF_MEMORY;
+        }
+        catch (...)
+        {
+            return CS_INTERNAL_ERROR;
+        }
+    }
+
+    cs_graph* Own(CsrGraph graph)
+    {
+        cs_graph* result = new cs_graph;
+        result->owned = std::move(graph);
+        result->view = CsrGraph::Borrow(result->owned.n, result->owned.offsets.data(), result->owned.adjacency.data());
+        result->offsets = result->owned.offsets.data();
+        return result;
+    }
+
+    // the fields the caller's version of the struct has, defaults for the rest
+    cs_clique_options ReadOptions(const cs_clique_options* options)
+    {
+        cs_clique_options result;
+        cs_clique_options_init(&result);
+        if (options != nullptr)
+        {
+            const size_t known = std::min<size_t>(options->size, sizeof(result));
+            std::memcpy(&result, options, known);
+            result.size = sizeof(result);
+        }
+        return result;
+    }
+
+    int StoreClique(std::vector<int> clique, int64_t weight, int32_t* out, cs_clique_result* result)
+    {
+        std::sort(clique.begin(), clique.end());
+        std::copy(clique.begin(), clique.end(), out);
+        result->size = static_cast<int32_t>(clique.size());
+        result->weight = weight;
+        return CS_OK;
+    }
+}
+
+extern "C"
+{
+
+int cs_abi_version(void)
+{
+    return CS_ABI_VERSION;
+}
+
+const char* cs_status_string(int status)
+{
+    switch (status)
+    {
+    case CS_OK: return "ok";
+    case CS_INVALID_ARGUMENT: return "invalid argument";
+    case CS_INVALID_GRAPH: return "invalid graph";
+    case CS_IO_ERROR: return "cannot read the graph file";
+    case CS_OUT_OF_MEMORY: return "out of memory";
+    case CS_INTERNAL_ERROR: return "internal error";
+    }
+    return "unknown status";
+}
+
+int cs_graph_borrow_csr(int32_t n, const uint64_t* offsets, const int32_t* adjacency, cs_graph** graph)
+{
+    if (graph == nullptr || n < 0 || offsets == nullptr || (adjacency == nullptr && offsets[n] > 0))
+        return CS_INVALID_ARGUMENT;
+    return Guarded([&]() -> int
+    {
+        cs_graph* result = new cs_graph;
+        result->view = CsrGraph::Borrow(n, offsets, adjacency);
+        result->offsets = offsets;
+        *graph = result;
+        return CS_OK;
+    });
+}
+
+int cs_graph_from_edges(int32_t n, const int32_t* edges, int64_t edge_count, cs_graph** graph)
+{
+    if (graph == nullptr || n < 0 || edge_count < 0 || (edges == nullptr && edge_count > 0))
+        return CS_INVALID_ARGUMENT;
+    for (int64_t i = 0; i < 2 * edge_count; ++i)
+        if (edges[i] < 0 || edges[i] >= n) return CS_INVALID_GRAPH;
+    return Guarded([&]() -> int
+    {
+        std::vector<EdgeChunks> parts(1);
+        for (int64_t i = 0; i < edge_count; ++i)
+            if (edges[2 * i] != edges[2 * i + 1]) parts[0].Append(edges[2 * i], edges[2 * i + 1]);
+        *graph = Own(BuildCsrGraph(n, parts));
+        return CS_OK;
+    });
+}
+
+int cs_graph_read_dimacs(const char* path, cs_graph** graph)
+{
+    if (graph == nullptr || path == nullptr)
+        return CS_INVALID_ARGUMENT;
+    return Guarded([&]() -> int
+    {
+        CsrGraph csr;
+        DimacsInfo info;
+        if (!ReadDimacsGraph(path, csr, info))
+            return CS_IO_ERROR;
+        *graph = Own(std::move(csr));
+        return CS_OK;
+    });
+}
+
+int cs_graph_check(const cs_graph* graph)
+{
+    if (graph == nullptr)
+        return CS_INVALID_ARGUMENT;
+    const CsrGraph& g = graph->view;
+    if (graph->offsets[0] != 0)
+        return CS_INVALID_GRAPH;
+    for (int v = 0; v < g.n; ++v)
+        if (graph->offsets[v + 1] < graph->offsets[v]) return CS_INVALID_GRAPH;
+    for (int v = 0; v < g.n; ++v)
+    {
+        std::span<const int> neighbours = g.Neighbours(v);
+        for (size_t i = 0; i < neighbours.size(); ++i)
+        {
+            const int u = neighbours[i];
+            if (u < 0 || u >= g.n || u == v || (i > 0 && neighbours[i - 1] >= u) || !g.HasEdge(u, v))
+                return CS_INVALID_GRAPH;
+        }
+    }
+    return CS_OK;
+}
+
+int32_t cs_graph_vertex_count(const cs_graph* graph)
+{
+    return graph == nullptr ? 0 : graph->view.n;
+}
+
+int64_t cs_graph_edge_count(const cs_graph* graph)
+{
+    return graph == nullptr ? 0 : graph->view.EdgeCount();
+}
+
+void cs_graph_free(cs_graph* graph)
+{
+    delete graph;
+}
+
+int cs_color(const cs_graph* graph, const char* strategy, int32_t* colors, int32_t* color_count)
+{
+    if (graph == nullptr || colors == nullptr || color_count == nullptr)
+        return CS_INVALID_ARGUMENT;
+    ColoringStrategy engine_strategy = ColoringStrategy::Dsatur;
+    if (strategy != nullptr && !ParseColoringStrategy(strategy, engine_strategy))
+        return CS_INVALID_ARGUMENT;
+    return Guarded([&]() -> int
+    {
+        ColoringProblem problem;
+        problem.SetGraph(graph->view);
+        if (strategy == nullptr)
+            problem.GreedyGraphColoring();
+        else
+            problem.ColorWith(engine_strategy);
+        const std::vector<int>& result = problem.GetColors();
+        std::copy(result.begin(), result.end(), colors);
+        *color_count = problem.GetNumberOfColors();
+        return CS_OK;
+    });
+}
+
+void cs_clique_options_init(cs_clique_options* options)
+{
+    if (options == nullptr)
+        return;
+    std::memset(options, 0, sizeof(*options));
+    options->size = sizeof(*options);
+    options->seed = kDefaultSeed;
+    options->threads = 1;
+}
+
+int cs_clique_grasp(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                    cs_clique_result* result)
+{
+    if (graph == nullptr || clique == nullptr || result == nullptr)
+        return CS_INVALID_ARGUMENT;
+    const cs_clique_options opts = ReadOptions(options);
+    return Guarded([&]() -> int
+    {
+        *result = cs_clique_result();
+        MaxCliqueProblem<> problem(opts.seed);
+        problem.SetGraph(graph->view);
+        problem.SetTimeLimit(opts.time_limit);
+        problem.FindClique(opts.randomization > 0 ? opts.randomization : 10,
+                           opts.iterations > 0 ? opts.iterations : 1000, opts.threads, opts.deterministic != 0);
+        std::vector<int> found = problem.GetClique();
+        const int64_t size = static_cast<int64_t>(found.size());
+        return StoreClique(std::move(found), size, clique, result);
+    });
+}
+
+int cs_clique_tabu(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                   cs_clique_result* result)
+{
+    if (graph == nullptr || clique == nullptr || result == nullptr)
+        return CS_INVALID_ARGUMENT;
+    const cs_clique_options opts = ReadOptions(options);
+    return Guarded([&]() -> int
+    {
+        *result = cs_clique_result();
+        MaxCliqueTabuSearch<> problem(opts.seed);
+        problem.SetGraph(graph->view);
+        problem.SetTimeLimit(opts.time_limit);
+        problem.RunSearch(opts.iterations > 0 ? opts.iterations : 200000,
+                          opts.randomization > 0 ? opts.randomization : 1000);
+        const std::unordered_set<int> found = problem.GetClique();
+        return StoreClique(std::vector<int>(found.begin(), found.end()), static_cast<int64_t>(found.size()), clique,
+                           result);
+    });
+}
+
+int cs_clique_bnb(const cs_graph* graph, const cs_clique_options* options, int32_t* clique,
+                  cs_clique_result* result)
+{
+    if (graph == nullptr || clique == nullptr || result == nullptr)
+        return CS_INVALID_ARGUMENT;
+    const cs_clique_options opts = ReadOptions(options);
+    return Guarded([&]() -> int
+    {
+        *result = cs_clique_result();
+        BnBSolver<> solver(opts.seed);
+        solver.SetGraph(graph->view);
+        std::string error;
+        if (opts.weights != nullptr &&
+            !solver.SetWeights(std::vector<int64_t>(opts.weights, opts.weights + graph->view.n), error))
+            return CS_INVALID_ARGUMENT;
+        solver.SetTimeLimit(opts.time_limit);
+        solver.RunBnB(std::max(1, opts.threads), opts.deterministic != 0);
+        const std::unordered_set<int> found = solver.GetClique();
+        result->optimal = !solver.TimedOut();
+        result->nodes = solver.Nodes();
+        return StoreClique(std::vector<int>(found.begin(), found.end()), solver.GetWeight(), clique, result);
+    });
+}
+
+int cs_clique_bnb_subsets(const cs_graph* graph, const cs_clique_options* options, const int32_t* const* subsets,
+                          const int32_t* sizes, int64_t count, cs_subset_callback callback, void* context)
+{
+    if (graph == nullptr || count < 0 || count > INT32_MAX || callback == nullptr ||
+        (count > 0 && (subsets == nullptr || sizes == nullptr)))
+        return CS_INVALID_ARGUMENT;
+    for (int64_t q = 0; q < count; ++q)
+        if (sizes[q] < 0 || (sizes[q] > 0 && subsets[q] == nullptr)) return CS_INVALID_ARGUMENT;
+    const cs_clique_options opts = ReadOptions(options);
+    return Guarded([&]() -> int
+    {
+        std::vector<std::vector<int>> queries(static_cast<size_t>(count));
+        for (int64_t q = 0; q < count; ++q)
+        {
+            for (int32_t i = 0; i < sizes[q]; ++i)
+                if (subsets[q][i] < 0 || subsets[q][i] >= graph->view.n) return CS_INVALID_ARGUMENT;
+            queries[q].assign(subsets[q], subsets[q] + sizes[q]);
+        }
+        BnBSolver<> solver(opts.seed);
+        solver.SetGraph(graph->view);
+        std::string error;
+        if (opts.weights != nullptr &&
+            !solver.SetWeights(std::vector<int64_t>(opts.weights, opts.weights + graph->view.n), error))
+            return CS_INVALID_ARGUMENT;
+        solver.SolveSubsets(queries, std::max(1, opts.threads), opts.time_limit,
+                            [&](const BnBSolver<>::SubsetResult& answer)
+        {
+            cs_clique_result result = cs_clique_result();
+            result.size = static_cast<int32_t>(answer.clique.size());
+            result.weight = answer.weight;
+            result.optimal = answer.optimal;
+            result.nodes = answer.nodes;
+            callback(context, static_cast<int64_t>(answer.query), answer.clique.data(), &result);
+        });
+        return CS_OK;
+    });
+}
+
+}
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "results_log.h"
+#include "run_options.h"
+
+using namespace std;
+
+// Compares two runs from a results log (common/results_log.h) instance by instance and flags
+// significant changes of wall time and solution quality.
+//
+//   compare-results [--log results.jsonl] [--alpha 0.05] [--min-change 0.05] [BASE [NEW]]
+//
+// BASE and NEW select records by --tag, by run id or by a git hash prefix; without them the
+// last two runs of the log are compared, with only BASE the last run is NEW. Repeated runs
+// with the same tag (other seeds, say) are pooled: times are compared by Welch's t-test on
+// their logarithms, sizes by Welch's t-test when they vary and exactly when they do not.
+// Over all instances a Wilcoxon signed-rank test on the time ratios catches slowdowns too
+// small to show on any single instance. Exits with 2 when it finds a regression.
+
+
+// I_x(a, b) by its continued fraction (Numerical Recipes, betacf)
+double RegularizedBeta(double a, double b, double x)
+{
+    if (x <= 0.0)
+        return 0.0;
+    if (x >= 1.0)
+        return 1.0;
+    if (x > (a + 1.0) / (a + b + 2.0))
+        return 1.0 - RegularizedBeta(b, a, 1.0 - x);
+
+    const double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x)) / a;
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    d = 1.0 / (fabs(d) < tiny ? tiny : d);
+    double f = d;
+    for (int m = 1; m <= 300; ++m)
+    {
+        for (int half = 0; half < 2; ++half)
+        {
+            const double numerator = half == 0 ? m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+                                               : -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+            d = 1.0 + numerator * d;
+            d = 1.0 / (fabs(d) < tiny ? tiny : d);
+            c = 1.0 + numerator / c;
+            c = fabs(c) < tiny ? tiny : c;
+            f *= c * d;
+        }
+        if (fabs(c * d - 1.0) < 1e-12)
+            break;
+    }
+    return front * f;
+}
+
+struct Sample
+{
+    double mean = 0.0;
+    double variance = 0.0; // unbiased, 0 for a single value
+    int n = 0;
+};
+
+Sample Summarize(const vector<double>& values)
+{
+    Sample s;
+    s.n = static_cast<int>(values.size());
+    for (double v : values) s.mean += v;
+    s.mean /= max(1, s.n);
+    for (double v : values) s.variance += (v - s.mean) * (v - s.mean);
+    s.variance = s.n > 1 ? s.variance / (s.n - 1) : 0.0;
+    return s;
+}
+
+// Two-sided p-value of Welch's t-test; -1 when either side has fewer than two values.
+double WelchPValue(const Sample& a, const Sample& b)
+{
+    if (a.n < 2 || b.n < 2)
+        return -1.0;
+    const double va = a.variance / a.n;
+    const double vb = b.variance / b.n;
+    if (va + vb <= 0.0)
+        return a.mean == b.mean ? 1.0 : 0.0;
+    const double t = (b.mean - a.mean) / sqrt(va + vb);
+    const double df = (va + vb) * (va + vb) / (va * va / (a.n - 1) + vb * vb / (b.n - 1));
+    return RegularizedBeta(df / 2.0, 0.5, df / (df + t * t));
+}
+
+// Two-sided p-value of the Wilcoxon signed-rank test by the normal approximation with tie
+// correction; -1 when there are no nonzero differences.
+double WilcoxonPValue(const vector<double>& differences)
+{
+    vector<double> nonzero;
+    for (double d : differences)
+        if (fabs(d) > 1e-12) nonzero.push_back(d);
+    const int n = static_cast<int>(nonzero.size());
+    if (n == 0)
+        return -1.0;
+    sort(nonzero.begin(), nonzero.end(), [](double a, double b) { return fabs(a) < fabs(b); });
+
+    double positive_ranks = 0.0;
+    double ties = 0.0;
+    for (int i = 0; i < n;)
+    {
+        int j = i;
+        while (j < n && fabs(nonzero[j]) - fabs(nonzero[i]) < 1e-12) ++j;
+        const double rank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; ++k)
+            if (nonzero[k] > 0.0) positive_ranks += rank;
+        const double t = j - i;
+        ties += t * t * t - t;
+        i = j;
+    }
+    const double mean = n * (n + 1) / 4.0;
+    const double variance = n * (n + 1) * (2.0 * n + 1) / 24.0 - ties / 48.0;
+    if (variance <= 0.0)
+        return 1.0;
+    const double z = (positive_ranks - mean) / sqrt(variance);
+    return erfc(fabs(z) / sqrt(2.0));
+}
+
+bool Selects(const RunRecord& record, const string& selector)
+{
+    return record.tag == selector || record.run == selector ||
+           (selector.size() >= 4 && record.git.compare(0, selector.size(), selector) == 0);
+}
+
+// values that differ between the two sides, as "name: base -> new"
+void ReportSetting(const string& name, const set<string>& base, const set<string>& next)
+{
+    if (base == next)
+        return;
+    auto join = [](const set<string>& values)
+    {
+        string text;
+        for (const string& value : values) text += (text.empty() ? "" : ", ") + value;
+        return text;
+    };
+    cout << "  " << name << ": " << join(base) << " -> " << join(next) << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    RunOptions options;
+    if (!ParseRunOptions(argc, argv, options, {"log", "alpha", "min-change"}))
+        return 1;
+    const string log_file = options.Value("log", "results.jsonl");
+    const double alpha = atof(options.Value("alpha", "0.05").c_str());
+    const double min_change = atof(options.Value("min-change", "0.05").c_str());
+
+    vector<RunRecord> records;
+    if (!ReadRunRecords(log_file, records))
+        return 1;
+
+    vector<string> runs;
+    for (const RunRecord& record : records)
+        if (find(runs.begin(), runs.end(), record.run) == runs.end()) runs.push_back(record.run);
+    string base_selector, new_selector;
+    if (options.positional.size() >= 2)
+    {
+        base_selector = options.positional[0];
+        new_selector = options.positional[1];
+    }
+    else if (options.positional.size() == 1 && !runs.empty())
+    {
+        base_selector = options.positional[0];
+        new_selector = runs.back();
+    }
+    else if (options.positional.empty() && runs.size() >= 2)
+    {
+        base_selector = runs[runs.size() - 2];
+        new_selector = runs.back();
+    }
+    else
+    {
+        cerr << "Error: Nothing to compare in '" << log_file << "'\n";
+        return 1;
+    }
+
+    // program and instance -> the records of each side
+    map<pair<string, string>, vector<const RunRecord*>> base_runs, new_runs;
+    set<string> base_settings[3], new_settings[3];
+    for (const RunRecord& record : records)
+    {
+        const bool in_base = Selects(record, base_selector);
+        const bool in_new = Selects(record, new_selector);
+        if (in_base == in_new)
+            continue;
+        (in_base ? base_runs : new_runs)[{record.program, record.instance}].push_back(&record);
+        set<string>* settings = in_base ? base_settings : new_settings;
+        settings[0].insert(record.git);
+        settings[1].insert(record.flags);
+        settings[2].insert(to_string(record.threads) + (record.deterministic ? " deterministic" : ""));
+    }
+    if (base_runs.empty() || new_runs.empty())
+    {
+        cerr << "Error: No records match '" << (base_runs.empty() ? base_selector : new_selector)
+             << "' apart from the other side\n";
+        return 1;
+    }
+
+    cout << "Base: " << base_selector << "\nNew:  " << new_selector << '\n';
+    ReportSetting("git", base_settings[0], new_settings[0]);
+    ReportSetting("flags", base_settings[1], new_settings[1]);
+    ReportSetting("threads", base_settings[2], new_settings[2]);
+    cout << "\nProgram; Instance; Runs; Base time; New time; Ratio; p; Base size; New size; Verdict\n";
+
+    int regressions = 0;
+    vector<double> log_ratios;
+    for (const auto& [key, base_side] : base_runs)
+    {
+        auto it = new_runs.find(key);
+        if (it == new_runs.end())
+            continue;
+        const vector<const RunRecord*>& new_side = it->second;
+
+        auto collect = [](const vector<const RunRecord*>& side, bool log_time)
+        {
+            vector<double> values;
+            for (const RunRecord* record : side)
+                values.push_back(log_time ? log(max(record->wall_sec, 1e-6)) : static_cast<double>(record->size));
+            return values;
+        };
+        const Sample base_time = Summarize(collect(base_side, true));
+        const Sample new_time = Summarize(collect(new_side, true));
+        const Sample base_size = Summarize(collect(base_side, false));
+        const Sample new_size = Summarize(collect(new_side, false));
+        const double ratio = exp(new_time.mean - base_time.mean);
+        const double time_p = WelchPValue(base_time, new_time);
+        log_ratios.push_back(new_time.mean - base_time.mean);
+
+        string verdict;
+        const bool minimize = base_side.front()->minimize;
+        const bool worse = minimize ? new_size.mean > base_size.mean : new_size.mean < base_size.mean;
+        const bool better = minimize ? new_size.mean < base_size.mean : new_size.mean > base_size.mean;
+        // sizes that do not vary differ for certain, seeded runs are usually like that
+        const double size_p = base_size.variance + new_size.variance > 0.0 ? WelchPValue(base_size, new_size) : 0.0;
+        if (worse && size_p >= 0.0 && size_p < alpha)
+            verdict = "WORSE";
+        else if (better && size_p >= 0.0 && size_p < alpha)
+            verdict = "better";
+        if (time_p >= 0.0 && time_p < alpha && ratio > 1.0 + min_change)
+            verdict += verdict.empty() ? "SLOWER" : ", SLOWER";
+        else if (time_p >= 0.0 && time_p < alpha && ratio < 1.0 / (1.0 + min_change))
+            verdict += verdict.empty() ? "faster" : ", faster";
+        if (verdict.find("WORSE") != string::npos || verdict.find("SLOWER") != string::npos)
+            ++regressions;
+
+        cout << key.first << "; " << key.second << "; " << base_time.n << "/" << new_time.n << "; " << fixed
+             << setprecision(6) << exp(base_time.mean) << "; " << exp(new_time.mean) << "; " << setprecision(3)
+             << ratio << "; ";
+        if (time_p >= 0.0)
+            cout << setprecision(4) << time_p;
+        else
+            cout << "-";
+        cout << "; " << setprecision(2) << base_size.mean << "; " << new_size.mean << "; "
+             << (verdict.empty() ? "=" : verdict) << '\n';
+    }
+    if (log_ratios.empty())
+    {
+        cerr << "Error: The two runs have no instance in common\n";
+        return 1;
+    }
+
+    double mean_log_ratio = 0.0;
+    for (double r : log_ratios) mean_log_ratio += r;
+    mean_log_ratio /= log_ratios.size();
+    const double overall_ratio = exp(mean_log_ratio);
+    const double overall_p = WilcoxonPValue(log_ratios);
+    cout << "\nInstances: " << log_ratios.size() << ", geometric mean time ratio " << setprecision(3) << overall_ratio
+         << ", Wilcoxon p " << (overall_p >= 0.0 ? to_string(overall_p) : string("-"));
+    if (overall_p >= 0.0 && overall_p < alpha && overall_ratio > 1.0 + min_change)
+    {
+        cout << ", SLOWER overall";
+        ++regressions;
+    }
+    else if (overall_p >= 0.0 && overall_p < alpha && overall_ratio < 1.0 / (1.0 + min_change))
+    {
+        cout << ", faster overall";
+    }
+    cout << '\n' << (regressions > 0 ? "Regressions found\n" : "No regressions\n");
+    return regressions > 0 ? 2 : 0;
+}
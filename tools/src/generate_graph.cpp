@@ -0,0 +1,56 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "graph_gen.h"
+#include "graph_io.h"
+#include "run_options.h"
+
+using namespace std;
+
+// Writes a synthetic graph in DIMACS format (common/graph_gen.h).
+//
+//   generate-graph gnp       --n N --p P                       [--seed S] [--output FILE]
+//   generate-graph hidden    --n N --p P --clique K [--hide H]
+//   generate-graph mycielski --order K
+//   generate-graph powerlaw  --n N [--gamma G] [--degree D]
+//
+// Without --output the file is named after the parameters, e.g. gnp_n1000_p0.5_s1234567.clq,
+// and written to --input-dir or the current directory.
+
+
+int main(int argc, char** argv)
+{
+    RunOptions options;
+    if (!ParseRunOptions(argc, argv, options, {"n", "p", "clique", "hide", "order", "gamma", "degree"}))
+        return 1;
+
+    GraphSpec spec;
+    if (options.positional.size() != 1 || !ParseGraphFamily(options.positional[0], spec.family))
+    {
+        cerr << "Error: Expected one family: gnp, hidden, mycielski or powerlaw\n";
+        return 1;
+    }
+    spec.n = atoi(options.Value("n", to_string(spec.n)).c_str());
+    spec.p = atof(options.Value("p", to_string(spec.p)).c_str());
+    spec.clique = atoi(options.Value("clique", to_string(spec.clique)).c_str());
+    spec.hide = atof(options.Value("hide", to_string(spec.hide)).c_str());
+    spec.order = atoi(options.Value("order", to_string(spec.order)).c_str());
+    spec.gamma = atof(options.Value("gamma", to_string(spec.gamma)).c_str());
+    spec.average_degree = atof(options.Value("degree", to_string(spec.average_degree)).c_str());
+    spec.seed = options.seed;
+    if (spec.n < 1 || spec.p < 0.0 || spec.p > 1.0)
+    {
+        cerr << "Error: Need --n of at least 1 and --p in [0, 1]\n";
+        return 1;
+    }
+
+    string output = options.output;
+    if (output.empty())
+        output = (options.input_dir.empty() ? "" : options.input_dir + "/") + GraphSpecName(spec);
+    const CsrGraph graph = GenerateGraph(spec);
+    if (!WriteDimacsGraph(output, graph, GraphSpecComments(spec)))
+        return 1;
+    cout << output << ": " << graph.n << " vertices, " << graph.EdgeCount() << " edges\n";
+    return 0;
+}
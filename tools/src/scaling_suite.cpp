@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "graph_gen.h"
+#include "graph_io.h"
+#include "results_log.h"
+#include "run_options.h"
+
+using namespace std;
+
+// Sweeps graph size and density for every solver and writes time and memory curves.
+//
+//   scaling-suite [--bin-dir build] [--work-dir scaling] [--family gnp|hidden|powerlaw|mycielski]
+//                 [--sizes 100,200,...] [--densities 0.1,0.5,0.9] [--solvers dsatur,grasp,tabu,bnb]
+//                 [--time-limit 10] [--output scaling.csv]
+//
+// The solvers are the driver binaries, found as <bin-dir>/<project>/<target> (configure each
+// project into build/<project>). Every graph runs in a process of its own so that its peak
+// RSS is its own; the numbers come back through the results log. Densities are edge
+// probabilities, or average degrees for powerlaw; for mycielski the sizes are orders. Once a
+// solver reaches the time limit at some size, larger sizes of that density are skipped. The
+// Exponent column is the slope of log time over log n since the previous size, so a solver
+// whose complexity breaks down shows a jump there.
+
+struct SuiteSolver
+{
+    string name;
+    string project;
+    string target;
+};
+
+const vector<SuiteSolver> kSuiteSolvers = {
+    {"dsatur", "week1", "week-1-pr"},
+    {"grasp", "lab2", "lab-2-pr"},
+    {"tabu", "lab3", "lab-3-pr"},
+    {"bnb", "lab4", "lab-4-pr"},
+};
+
+vector<string> SplitList(const string& text)
+{
+    vector<string> items;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ','))
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+string Quote(const string& text)
+{
+    string quoted = "'";
+    for (char c : text) quoted += c == '\'' ? string("'\\''") : string(1, c);
+    return quoted + "'";
+}
+
+int main(int argc, char** argv)
+{
+    RunOptions options;
+    if (!ParseRunOptions(argc, argv, options,
+                         {"bin-dir", "work-dir", "family", "sizes", "densities", "solvers", "clique", "gamma"}))
+        return 1;
+    namespace fs = filesystem;
+    const fs::path bin_dir = options.Value("bin-dir", "build");
+    const fs::path work_dir = options.Value("work-dir", "scaling");
+    const double time_limit = options.time_limit > 0.0 ? options.time_limit : 10.0;
+
+    GraphSpec base;
+    if (!ParseGraphFamily(options.Value("family", "gnp"), base.family))
+    {
+        cerr << "Error: Unknown family '" << options.Value("family") << "'\n";
+        return 1;
+    }
+    base.seed = options.seed;
+    base.gamma = atof(options.Value("gamma", to_string(base.gamma)).c_str());
+    const bool mycielski = base.family == GraphFamily::Mycielski;
+    const bool powerlaw = base.family == GraphFamily::PowerLaw;
+    const vector<string> sizes = SplitList(options.Value("sizes", mycielski ? "3,4,5,6,7,8,9" : "100,200,400,800,1600"));
+    const vector<string> densities =
+        mycielski ? vector<string>{"-"} : SplitList(options.Value("densities", powerlaw ? "8,32" : "0.1,0.5,0.9"));
+
+    vector<SuiteSolver> solvers;
+    for (const string& name : SplitList(options.Value("solvers", "dsatur,grasp,tabu,bnb")))
+    {
+        auto it = find_if(kSuiteSolvers.begin(), kSuiteSolvers.end(), [&](const SuiteSolver& s) { return s.name == name; });
+        if (it == kSuiteSolvers.end())
+        {
+            cerr << "Error: Unknown solver '" << name << "'\n";
+            return 1;
+        }
+        if (!fs::exists(bin_dir / it->project / it->target))
+        {
+            cerr << "Error: No " << (bin_dir / it->project / it->target).string() << ", build " << it->project
+                 << " into " << (bin_dir / it->project).string() << " or pass --bin-dir\n";
+            return 1;
+        }
+        solvers.push_back(*it);
+    }
+
+    error_code error;
+    fs::create_directories(work_dir, error);
+    const string log_file = (work_dir / "suite.jsonl").string();
+
+    ofstream fout(options.output.empty() ? "scaling.csv" : options.output);
+    const string header = "Solver; Family; n; Density; Edges; Result; Parse (sec); Time (sec); CPU (sec); "
+                          "Peak RSS (KB); Exponent; Status\n";
+    fout << header;
+    cout << header;
+    for (const string& density : densities)
+    {
+        // solver -> (n, time) of its last finished run at this density
+        map<string, pair<int, double>> previous;
+        map<string, bool> stopped;
+        for (const string& size : sizes)
+        {
+            GraphSpec spec = base;
+            if (mycielski)
+            {
+                spec.order = atoi(size.c_str());
+            }
+            else
+            {
+                spec.n = atoi(size.c_str());
+                if (powerlaw)
+                    spec.average_degree = atof(density.c_str());
+                else
+                    spec.p = atof(density.c_str());
+                spec.clique = options.Value("clique").empty() ? max(4, spec.n / 10) : atoi(options.Value("clique").c_str());
+            }
+            const string graph_path = (work_dir / GraphSpecName(spec)).string();
+            const CsrGraph graph = GenerateGraph(spec);
+            if (!WriteDimacsGraph(graph_path, graph, GraphSpecComments(spec)))
+                return 1;
+
+            for (const SuiteSolver& solver : solvers)
+            {
+                ostringstream row;
+                row << solver.name << "; " << GraphFamilyName(spec.family) << "; " << graph.n << "; " << density << "; "
+                    << graph.EdgeCount() << "; ";
+                if (stopped[solver.name])
+                {
+                    row << "-; -; -; -; -; -; skipped\n";
+                    fout << row.str();
+                    cout << row.str();
+                    continue;
+                }
+
+                vector<RunRecord> before;
+                if (fs::exists(log_file))
+                    ReadRunRecords(log_file, before);
+                const string command =
+                    Quote((bin_dir / solver.project / solver.target).string()) + " --seed " + to_string(options.seed) +
+                    " --threads " + to_string(options.threads) + " --time-limit " + to_string(time_limit) +
+                    " --results-log " + Quote(log_file) + " --tag scaling --output " +
+                    Quote((work_dir / (solver.name + ".csv")).string()) + " " + Quote(graph_path) + " >> " +
+                    Quote((work_dir / (solver.name + ".out")).string()) + " 2>&1";
+                const int status = system(command.c_str());
+                vector<RunRecord> after;
+                ReadRunRecords(log_file, after);
+
+                if (status != 0 || after.size() <= before.size())
+                {
+                    row << "-; -; -; -; -; -; failed\n";
+                    stopped[solver.name] = true;
+                    fout << row.str();
+                    cout << row.str();
+                    continue;
+                }
+                const RunRecord& record = after.back();
+                const bool timed_out = record.wall_sec >= 0.95 * time_limit;
+                row << record.size << "; " << fixed << setprecision(6) << record.parse_sec << "; " << record.wall_sec
+                    << "; " << record.cpu_sec << "; " << record.peak_rss_kb << "; ";
+                auto last = previous.find(solver.name);
+                if (last != previous.end() && graph.n > last->second.first && last->second.second > 0.0)
+                    row << setprecision(2) << log(max(record.wall_sec, 1e-6) / last->second.second) /
+                                                  log(static_cast<double>(graph.n) / last->second.first);
+                else
+                    row << "-";
+                row << "; " << (timed_out ? "time limit" : "ok") << '\n';
+                fout << row.str() << flush;
+                cout << row.str() << flush;
+                previous[solver.name] = {graph.n, max(record.wall_sec, 1e-6)};
+                stopped[solver.name] = timed_out;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,714 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "bnb_solver.h"
+#include "coloring_problem.h"
+#include "grasp_clique.h"
+#include "graph_io.h"
+#include "hybrid_bit_graph.h"
+#include "json.h"
+#include "results_log.h"
+#include "run_options.h"
+#include "tabu_search.h"
+#include "timing.h"
+
+using namespace std;
+
+// Keeps graphs in memory and answers coloring and clique requests on them over a Unix socket,
+// so that repeated queries pay neither for reading the file nor for building the solvers'
+// adjacency structures.
+//
+//   solver-daemon --socket PATH [--workers N] [--queue N] [--max-time-limit 60] [--threads 1]
+//                 [--results-log F] graph files or globs
+//
+// A request is one line of JSON and gets one line back:
+//   {"id": 7, "graph": "C125.9", "solver": "bnb", "time-limit": 5, "threads": 2}
+//   {"id": 7, "status": "ok", "size": 24, "weight": 24, "optimal": true, "nodes": 73684,
+//    "queue_ms": 0.03, "solve_ms": 245.2, "clique": [1, 4, ...]}
+// graph: a file name, with or without its extension. solver: color (with "strategy" one of
+// the ColoringEngine strategies, the week1 DSATUR without), grasp, tabu or bnb. "seed",
+// "iterations", "randomization", "deterministic" and "weights" (bnb, one per vertex) mean
+// what they mean for the drivers. Vertices are 1-based as in DIMACS. {"command": "stats"}
+// returns counts and latency percentiles per solver, {"command": "graphs"} the graphs.
+//
+// The graph, its bitset rows for bnb and, from the first tabu request on, its non-neighbour
+// lists are built once and shared read-only by every request. Requests wait in one queue of
+// --queue entries for the --workers threads; a request that finds the queue full is refused
+// at once with status "busy", so a burst cannot pile up unbounded latency. Time limits are
+// capped at --max-time-limit, which also applies to requests without one (0: no cap), and
+// threads per request at --threads. Every answered request goes to the results log with the
+// solve time as wall_sec. SIGINT or SIGTERM stops accepting, finishes the queue and exits.
+
+namespace
+{
+    atomic<bool> stop_requested{false};
+
+    void OnStopSignal(int)
+    {
+        stop_requested = true;
+    }
+}
+
+struct LoadedGraph
+{
+    string name;
+    CsrGraph csr;
+    shared_ptr<const HybridBitGraph> rows;
+    // O(n^2), so only built for graphs that get a tabu request
+    once_flag tabu_once;
+    shared_ptr<const TabuGraph> tabu;
+
+    // what the solvers get: the arrays of `csr`, not a copy
+    CsrGraph View() const
+    {
+        return CsrGraph::Borrow(csr.n, csr.offsets.data(), csr.adjacency.data());
+    }
+
+    shared_ptr<const TabuGraph> Tabu()
+    {
+        call_once(tabu_once, [&]() { tabu = make_shared<const TabuGraph>(csr); });
+        return tabu;
+    }
+};
+
+struct Request
+{
+    string id = "null"; // as JSON
+    LoadedGraph* graph = nullptr;
+    string solver;
+    string strategy;
+    uint64_t seed = kDefaultSeed;
+    int threads = 1;
+    bool deterministic = false;
+    double time_limit = 0.0;
+    int iterations = 0;
+    int randomization = 0;
+    vector<int64_t> weights;
+};
+
+struct Job
+{
+    Request request;
+    Stopwatch queued;
+    promise<string> reply;
+};
+
+// Bounded FIFO between the connections and the workers.
+class JobQueue
+{
+public:
+    explicit JobQueue(size_t capacity) : capacity(capacity) {}
+
+    // false, leaving `job` with the caller, when the queue is full or closed
+    bool TryPush(unique_ptr<Job>& job)
+    {
+        {
+            lock_guard<mutex> lock(guard);
+            if (closed || jobs.size() >= capacity)
+                return false;
+            jobs.push_back(move(job));
+        }
+        ready.notify_one();
+        return true;
+    }
+
+    // nullptr once the queue is closed and empty
+    unique_ptr<Job> Pop()
+    {
+        unique_lock<mutex> lock(guard);
+        ready.wait(lock, [&]() { return closed || !jobs.empty(); });
+        if (jobs.empty())
+            return nullptr;
+        unique_ptr<Job> job = move(jobs.front());
+        jobs.pop_front();
+        return job;
+    }
+
+    void Close()
+    {
+        {
+            lock_guard<mutex> lock(guard);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    size_t Size()
+    {
+        lock_guard<mutex> lock(guard);
+        return jobs.size();
+    }
+
+private:
+    size_t capacity;
+    mutex guard;
+    condition_variable ready;
+    deque<unique_ptr<Job>> jobs;
+    bool closed = false;
+};
+
+// Counts per solver and the latencies (queue wait + solve) of its last kWindow requests.
+class LatencyStats
+{
+public:
+    static constexpr size_t kWindow = 4096;
+
+    void Done(const string& solver, double queue_ms, double solve_ms)
+    {
+        lock_guard<mutex> lock(guard);
+        Solver& s = solvers[solver];
+        ++s.done;
+        s.queue_ms_sum += queue_ms;
+        s.solve_ms_sum += solve_ms;
+        if (s.latest.size() < kWindow)
+            s.latest.push_back(queue_ms + solve_ms);
+        else
+            s.latest[s.done % kWindow] = queue_ms + solve_ms;
+    }
+
+    void Busy(const string& solver)
+    {
+        lock_guard<mutex> lock(guard);
+        ++solvers[solver].busy;
+    }
+
+    void Failed(const string& solver)
+    {
+        lock_guard<mutex> lock(guard);
+        ++solvers[solver].failed;
+    }
+
+    string Json()
+    {
+        lock_guard<mutex> lock(guard);
+        ostringstream out;
+        out.precision(6);
+        out << '{';
+        bool first = true;
+        for (auto& [name, s] : solvers)
+        {
+            vector<double> sorted = s.latest;
+            sort(sorted.begin(), sorted.end());
+            auto percentile = [&](double p)
+            {
+                return sorted.empty() ? 0.0 : sorted[min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+            };
+            const double done = static_cast<double>(max<uint64_t>(1, s.done));
+            out << (first ? "" : ", ") << JsonQuote(name) << ": {\"done\": " << s.done << ", \"busy\": " << s.busy
+                << ", \"failed\": " << s.failed << ", \"queue_ms_mean\": " << s.queue_ms_sum / done
+                << ", \"solve_ms_mean\": " << s.solve_ms_sum / done << ", \"p50_ms\": " << percentile(0.5)
+                << ", \"p90_ms\": " << percentile(0.9) << ", \"p99_ms\": " << percentile(0.99)
+                << ", \"max_ms\": " << (sorted.empty() ? 0.0 : sorted.back()) << '}';
+            first = false;
+        }
+        out << '}';
+        return out.str();
+    }
+
+private:
+    struct Solver
+    {
+        uint64_t done = 0;
+        uint64_t busy = 0;
+        uint64_t failed = 0;
+        double queue_ms_sum = 0.0;
+        double solve_ms_sum = 0.0;
+        vector<double> latest; // ring buffer once full
+    };
+
+    mutex guard;
+    map<string, Solver> solvers;
+};
+
+struct DaemonConfig
+{
+    RunOptions options;
+    int workers = 1;
+    double max_time_limit = 60.0;
+};
+
+string ErrorReply(const string& id, const string& status, const string& message)
+{
+    return "{\"id\": " + id + ", \"status\": " + JsonQuote(status) + ", \"error\": " + JsonQuote(message) + "}";
+}
+
+// request members that must be numbers when present
+bool NumberMember(const JsonValue& request, const char* key, double& value, string& error)
+{
+    const JsonValue* member = request.Find(key);
+    if (member == nullptr)
+        return true;
+    if (member->type != JsonValue::Type::Number)
+    {
+        error = string("'") + key + "' must be a number";
+        return false;
+    }
+    value = strtod(member->text.c_str(), nullptr);
+    return true;
+}
+
+bool ParseRequest(const JsonValue& json, map<string, LoadedGraph*>& graphs, const DaemonConfig& config,
+                  Request& request, string& error)
+{
+    const JsonValue* graph = json.Find("graph");
+    const JsonValue* solver = json.Find("solver");
+    if (graph == nullptr || graph->type != JsonValue::Type::String || solver == nullptr ||
+        solver->type != JsonValue::Type::String)
+    {
+        error = "a request needs \"graph\" and \"solver\" strings";
+        return false;
+    }
+    auto found = graphs.find(graph->text);
+    if (found == graphs.end())
+    {
+        error = "unknown graph '" + graph->text + "'";
+        return false;
+    }
+    request.graph = found->second;
+    request.solver = solver->text;
+    if (request.solver != "color" && request.solver != "grasp" && request.solver != "tabu" && request.solver != "bnb")
+    {
+        error = "unknown solver '" + request.solver + "' (color, grasp, tabu, bnb)";
+        return false;
+    }
+
+    double seed = 0, threads = 1, time_limit = 0, iterations = 0, randomization = 0;
+    if (!NumberMember(json, "seed", seed, error) || !NumberMember(json, "threads", threads, error) ||
+        !NumberMember(json, "time-limit", time_limit, error) || !NumberMember(json, "iterations", iterations, error) ||
+        !NumberMember(json, "randomization", randomization, error))
+        return false;
+    if (const JsonValue* seed_member = json.Find("seed"))
+        request.seed = strtoull(seed_member->text.c_str(), nullptr, 10);
+    else
+        request.seed = config.options.seed;
+    request.threads = max(1, min(static_cast<int>(threads), config.options.threads));
+    if (config.max_time_limit > 0.0 && (time_limit <= 0.0 || time_limit > config.max_time_limit))
+        time_limit = config.max_time_limit;
+    request.time_limit = max(0.0, time_limit);
+    request.iterations = max(0, static_cast<int>(min(iterations, 1e9)));
+    request.randomization = max(0, static_cast<int>(min(randomization, 1e9)));
+    if (const JsonValue* deterministic = json.Find("deterministic"))
+        request.deterministic = deterministic->type == JsonValue::Type::Bool && deterministic->boolean;
+
+    if (const JsonValue* strategy = json.Find("strategy"))
+    {
+        ColoringStrategy parsed;
+        if (strategy->type != JsonValue::Type::String || !ParseColoringStrategy(strategy->text, parsed))
+        {
+            error = "unknown coloring strategy";
+            return false;
+        }
+        request.strategy = strategy->text;
+    }
+    if (const JsonValue* weights = json.Find("weights"))
+    {
+        if (weights->type != JsonValue::Type::Array ||
+            static_cast<int>(weights->items.size()) != request.graph->csr.n)
+        {
+            error = "\"weights\" must list one number per vertex";
+            return false;
+        }
+        for (const JsonValue& w : weights->items)
+            request.weights.push_back(w.type == JsonValue::Type::Number ? strtoll(w.text.c_str(), nullptr, 10) : 0);
+    }
+    return true;
+}
+
+void AppendList(ostringstream& out, const char* key, const vector<int>& values)
+{
+    out << ", \"" << key << "\": [";
+    for (size_t i = 0; i < values.size(); ++i) out << (i ? ", " : "") << values[i];
+    out << ']';
+}
+
+// sorted and 1-based
+void AppendClique(ostringstream& out, vector<int> clique)
+{
+    sort(clique.begin(), clique.end());
+    for (int& v : clique) ++v;
+    AppendList(out, "clique", clique);
+}
+
+// The solver part of the reply, after "status": "ok"; false with `error` set otherwise.
+bool RunRequest(const Request& r, ostringstream& out, int64_t& size, string& error)
+{
+    LoadedGraph& graph = *r.graph;
+    if (r.solver == "color")
+    {
+        ColoringProblem problem(r.seed);
+        problem.SetGraph(graph.View());
+        ColoringStrategy strategy;
+        if (ParseColoringStrategy(r.strategy, strategy))
+            problem.ColorWith(strategy);
+        else
+            problem.GreedyGraphColoring();
+        size = problem.GetNumberOfColors();
+        out << ", \"size\": " << size;
+        AppendList(out, "colors", problem.GetColors());
+        return true;
+    }
+    if (r.solver == "grasp")
+    {
+        MaxCliqueProblem<> problem(r.seed);
+        problem.SetGraph(graph.View());
+        problem.SetTimeLimit(r.time_limit);
+        problem.FindClique(r.randomization > 0 ? r.randomization : 10, r.iterations > 0 ? r.iterations : 1000,
+                           r.threads, r.deterministic);
+        const vector<int> clique = problem.GetClique();
+        size = static_cast<int64_t>(clique.size());
+        out << ", \"size\": " << size;
+        AppendClique(out, clique);
+        return true;
+    }
+    if (r.solver == "tabu")
+    {
+        MaxCliqueTabuSearch<> problem(r.seed);
+        problem.SetGraph(graph.View(), graph.Tabu());
+        problem.SetTimeLimit(r.time_limit);
+        problem.RunSearch(r.iterations > 0 ? r.iterations : 200000, r.randomization > 0 ? r.randomization : 1000);
+        const unordered_set<int> clique = problem.GetClique();
+        size = static_cast<int64_t>(clique.size());
+        out << ", \"size\": " << size;
+        AppendClique(out, vector<int>(clique.begin(), clique.end()));
+        return true;
+    }
+
+    BnBSolver<> problem(r.seed);
+    problem.SetGraph(graph.View(), graph.rows);
+    if (!r.weights.empty() && !problem.SetWeights(r.weights, error))
+        return false;
+    problem.SetTimeLimit(r.time_limit);
+    problem.RunBnB(r.threads, r.deterministic);
+    const unordered_set<int> clique = problem.GetClique();
+    size = problem.GetWeight();
+    out << ", \"size\": " << clique.size() << ", \"weight\": " << size
+        << ", \"optimal\": " << (problem.TimedOut() ? "false" : "true") << ", \"nodes\": " << problem.Nodes();
+    AppendClique(out, vector<int>(clique.begin(), clique.end()));
+    return true;
+}
+
+void Work(JobQueue& queue, LatencyStats& stats, const DaemonConfig& config)
+{
+    while (unique_ptr<Job> job = queue.Pop())
+    {
+        const Request& r = job->request;
+        const double queue_ms = job->queued.Seconds() * 1000.0;
+        Stopwatch watch;
+        ostringstream out;
+        out.precision(6);
+        int64_t size = 0;
+        string error;
+        bool solved = false;
+        try
+        {
+            solved = RunRequest(r, out, size, error);
+        }
+        catch (const bad_alloc&)
+        {
+            error = "out of memory";
+        }
+        catch (const exception& e)
+        {
+            error = string("internal error: ") + e.what();
+        }
+        catch (...)
+        {
+            error = "internal error";
+        }
+        if (!solved)
+        {
+            stats.Failed(r.solver);
+            job->reply.set_value(ErrorReply(r.id, "error", error));
+            continue;
+        }
+        ResourceUsage solve = watch.Elapsed();
+        // CPU time of one request cannot be told apart from the others running next to it
+        solve.cpu_sec = 0.0;
+        const double solve_ms = solve.wall_sec * 1000.0;
+        stats.Done(r.solver, queue_ms, solve_ms);
+
+        ostringstream reply;
+        reply.precision(6);
+        reply << "{\"id\": " << r.id << ", \"status\": \"ok\", \"queue_ms\": " << queue_ms
+              << ", \"solve_ms\": " << solve_ms << out.str() << '}';
+        job->reply.set_value(reply.str());
+
+        RunOptions run = config.options;
+        run.seed = r.seed;
+        run.threads = r.threads;
+        run.deterministic = r.deterministic;
+        AppendRunRecord(run, MakeRunRecord(run, "solver-daemon " + r.solver, r.graph->name, ResourceUsage(), solve,
+                                           size, r.solver == "color"));
+    }
+}
+
+string GraphsReply(const string& id, const vector<unique_ptr<LoadedGraph>>& loaded)
+{
+    ostringstream out;
+    out << "{\"id\": " << id << ", \"status\": \"ok\", \"graphs\": [";
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        const LoadedGraph& g = *loaded[i];
+        out << (i ? ", " : "") << "{\"name\": " << JsonQuote(g.name) << ", \"vertices\": " << g.csr.n
+            << ", \"edges\": " << g.csr.EdgeCount() << ", \"row_bytes\": " << g.rows->MemoryBytes() << '}';
+    }
+    out << "]}";
+    return out.str();
+}
+
+struct Daemon
+{
+    DaemonConfig config;
+    vector<unique_ptr<LoadedGraph>> loaded;
+    map<string, LoadedGraph*> graphs; // by file name and by file name without extension
+    JobQueue queue;
+    LatencyStats stats;
+    Stopwatch uptime;
+
+    // open connections, so that shutdown can close them and wait for their threads
+    mutex clients_guard;
+    condition_variable clients_done;
+    vector<int> clients;
+
+    explicit Daemon(const DaemonConfig& config, size_t capacity) : config(config), queue(capacity) {}
+
+    void Connect(int fd)
+    {
+        {
+            lock_guard<mutex> lock(clients_guard);
+            clients.push_back(fd);
+        }
+        thread([this, fd]() { Serve(fd); }).detach();
+    }
+
+    // after the queue is drained: ends the connections and waits for their threads
+    void Disconnect()
+    {
+        unique_lock<mutex> lock(clients_guard);
+        for (int fd : clients) shutdown(fd, SHUT_RDWR);
+        clients_done.wait(lock, [&]() { return clients.empty(); });
+    }
+
+    string Handle(const string& line)
+    {
+        JsonValue json;
+        string error;
+        if (!JsonParser(line).Parse(json, error) || json.type != JsonValue::Type::Object)
+            return ErrorReply("null", "error", error.empty() ? "a request must be a JSON object" : error);
+        string id = "null";
+        if (const JsonValue* member = json.Find("id"))
+            id = member->type == JsonValue::Type::String ? JsonQuote(member->text) : member->ScalarText();
+        if (id.empty())
+            id = "null";
+
+        if (const JsonValue* command = json.Find("command"))
+        {
+            if (command->text == "graphs")
+                return GraphsReply(id, loaded);
+            if (command->text == "stats")
+            {
+                ostringstream out;
+                out.precision(6);
+                out << "{\"id\": " << id << ", \"status\": \"ok\", \"uptime_sec\": " << uptime.Seconds()
+                    << ", \"workers\": " << config.workers << ", \"queued\": " << queue.Size()
+                    << ", \"solvers\": " << stats.Json() << '}';
+                return out.str();
+            }
+            return ErrorReply(id, "error", "unknown command (stats, graphs)");
+        }
+
+        auto job = make_unique<Job>();
+        job->request.id = id;
+        if (!ParseRequest(json, graphs, config, job->request, error))
+            return ErrorReply(id, "error", error);
+        const string solver = job->request.solver;
+        future<string> reply = job->reply.get_future();
+        if (!queue.TryPush(job))
+        {
+            stats.Busy(solver);
+            return ErrorReply(id, "busy", "the request queue is full");
+        }
+        return reply.get();
+    }
+
+    // one thread per connection; requests on a connection are answered in order
+    void Serve(int fd)
+    {
+        constexpr size_t kMaxLine = size_t(64) << 20;
+        string buffer;
+        char chunk[1 << 16];
+        bool open = true;
+        while (open)
+        {
+            const ssize_t got = read(fd, chunk, sizeof(chunk));
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                break;
+            buffer.append(chunk, static_cast<size_t>(got));
+            size_t start = 0;
+            for (size_t end; open && (end = buffer.find('\n', start)) != string::npos; start = end + 1)
+            {
+                string line = buffer.substr(start, end - start);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.find_first_not_of(" \t") != string::npos)
+                    open = WriteAll(fd, Handle(line) + "\n");
+            }
+            buffer.erase(0, start);
+            if (buffer.size() > kMaxLine)
+            {
+                WriteAll(fd, ErrorReply("null", "error", "request line too long") + "\n");
+                break;
+            }
+        }
+        lock_guard<mutex> lock(clients_guard);
+        clients.erase(find(clients.begin(), clients.end(), fd));
+        close(fd);
+        clients_done.notify_all();
+    }
+
+    static bool WriteAll(int fd, const string& text)
+    {
+        for (size_t done = 0; done < text.size();)
+        {
+            const ssize_t put = send(fd, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+            if (put < 0 && errno == EINTR)
+                continue;
+            if (put <= 0)
+                return false;
+            done += static_cast<size_t>(put);
+        }
+        return true;
+    }
+};
+
+// A listening socket at `path`. A stale socket file is replaced, one with a live daemon
+// behind it is not.
+int Listen(const string& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Error: Socket path must have 1 to " << sizeof(address.sun_path) - 1 << " characters\n";
+        return -1;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        close(probe);
+        cerr << "Error: Another daemon listens on '" << path << "'\n";
+        return -1;
+    }
+    if (probe >= 0)
+        close(probe);
+    error_code ignored;
+    if (filesystem::is_socket(path, ignored))
+        filesystem::remove(path, ignored);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0)
+    {
+        cerr << "Error: Cannot listen on '" << path << "': " << strerror(errno) << '\n';
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char** argv)
+{
+    DaemonConfig config;
+    RunOptions& options = config.options;
+    if (!ParseRunOptions(argc, argv, options, {"socket", "workers", "queue", "max-time-limit"}))
+        return 1;
+    const string socket_path = options.Value("socket");
+    config.workers = max(1, atoi(options.Value("workers", to_string(DefaultThreadCount())).c_str()));
+    const int capacity = max(1, atoi(options.Value("queue", to_string(4 * config.workers)).c_str()));
+    config.max_time_limit = max(0.0, atof(options.Value("max-time-limit", "60").c_str()));
+    if (socket_path.empty() || options.positional.empty())
+    {
+        cerr << "Error: Need --socket PATH and at least one graph file\n";
+        return 1;
+    }
+
+    Daemon daemon(config, static_cast<size_t>(capacity));
+    for (const InstanceFile& instance : ListInstances(options, "", {}))
+    {
+        Stopwatch watch;
+        auto graph = make_unique<LoadedGraph>();
+        DimacsInfo info;
+        if (!ReadDimacsGraph(instance.path, graph->csr, info))
+            return 1;
+        graph->rows = make_shared<const HybridBitGraph>(graph->csr, false);
+        const filesystem::path file = filesystem::path(instance.path).filename();
+        graph->name = file.string();
+        for (const string& key : {file.string(), file.stem().string()})
+        {
+            if (!daemon.graphs.emplace(key, graph.get()).second && daemon.graphs[key] != graph.get())
+                cerr << "Warning: Graph name '" << key << "' is taken, use the full file name\n";
+        }
+        cout << "loaded " << graph->name << ": " << graph->csr.n << " vertices, " << graph->csr.EdgeCount()
+             << " edges, " << graph->rows->MemoryBytes() / 1024 << " KB of rows, " << watch.Seconds() << " s" << endl;
+        daemon.loaded.push_back(move(graph));
+    }
+
+    const int listener = Listen(socket_path);
+    if (listener < 0)
+        return 1;
+    struct sigaction action{};
+    action.sa_handler = OnStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    vector<thread> workers;
+    for (int w = 0; w < config.workers; ++w)
+        workers.emplace_back([&]() { Work(daemon.queue, daemon.stats, config); });
+    cout << "listening on " << socket_path << " with " << config.workers << " workers, queue " << capacity << endl;
+
+    while (!stop_requested)
+    {
+        pollfd waiting{listener, POLLIN, 0};
+        if (poll(&waiting, 1, 200) <= 0)
+            continue;
+        const int client = accept(listener, nullptr, nullptr);
+        if (client >= 0)
+            daemon.Connect(client);
+    }
+
+    close(listener);
+    unlink(socket_path.c_str());
+    daemon.queue.Close();
+    for (thread& w : workers) w.join();
+    daemon.Disconnect();
+    cout << "stopped, " << daemon.stats.Json() << endl;
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bit_graph.h"
+#include "memory_placement.h"
+#include "random.h"
+#include "run_options.h"
+
+using namespace std;
+
+// Access patterns of the B&B on a dense adjacency matrix, once per page mode, with the data
+// TLB misses counted by the kernel (perf_event_open).
+//
+//   tlb-benchmark [--vertices 32768] [--ops 20000000] [--modes off,thp,hugetlb] [--seed S]
+//
+// probe: one bit of a random row, as SelectNeighbours and the maximality test do;
+// row: a random row ANDed with a candidate bitset and counted, as the colorings do.
+// The matrix takes vertices^2 / 8 bytes (128 MB by default). The "huge MB" column is how
+// much of it the kernel really backed by huge pages; "n/a" in the miss column means that
+// the counter is not available (e.g. in a VM or under perf_event_paranoid > 2).
+
+class TlbMissCounter
+{
+public:
+    TlbMissCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~TlbMissCounter()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    bool Available() const
+    {
+        return fd >= 0;
+    }
+
+    void Start()
+    {
+#ifdef __linux__
+        if (fd < 0)
+            return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // misses since Start, -1 without a counter
+    int64_t Stop()
+    {
+        int64_t count = -1;
+#ifdef __linux__
+        if (fd < 0)
+            return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count))
+            count = -1;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+struct Measurement
+{
+    double seconds = 0.0;
+    int64_t misses = -1;
+    uint64_t checksum = 0;
+};
+
+template <class Work>
+Measurement Measure(TlbMissCounter& counter, Work&& work)
+{
+    Measurement m;
+    const auto start = chrono::steady_clock::now();
+    counter.Start();
+    m.checksum = work();
+    m.misses = counter.Stop();
+    m.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return m;
+}
+
+int main(int argc, char** argv)
+{
+    RunOptions options;
+    if (!ParseRunOptions(argc, argv, options, {"vertices", "ops", "modes"}))
+        return 1;
+    const int n = atoi(options.Value("vertices", "32768").c_str());
+    const int64_t ops = atoll(options.Value("ops", "20000000").c_str());
+    if (n < 64 || ops < 1)
+    {
+        cerr << "Error: Need --vertices of at least 64 and a positive --ops\n";
+        return 1;
+    }
+    vector<HugePages> modes;
+    stringstream list(options.Value("modes", "off,thp,hugetlb"));
+    for (string name; getline(list, name, ',');)
+    {
+        HugePages mode;
+        if (!ParseHugePages(name, mode))
+        {
+            cerr << "Error: Unknown huge page mode '" << name << "' (off, thp, hugetlb)\n";
+            return 1;
+        }
+        modes.push_back(mode);
+    }
+
+    TlbMissCounter counter;
+    cout << "matrix " << n << " x " << n << ", " << fixed << setprecision(1)
+         << static_cast<double>(n) * BitsetWords(n) * 8 / 1048576.0 << " MB, " << ops << " ops per pattern"
+         << (counter.Available() ? "" : ", dTLB counter not available") << '\n';
+    cout << left << setw(9) << "mode" << setw(10) << "huge MB" << setw(9) << "pattern" << right << setw(10)
+         << "seconds" << setw(10) << "ns/op" << setw(14) << "misses/op" << "  checksum\n";
+
+    for (HugePages mode : modes)
+    {
+        SetHugePages(mode);
+        const int64_t huge_before = HugePageKilobytes();
+        BitGraph graph(n);
+        Xoshiro256pp fill(options.seed);
+        for (uint64_t& word : graph.adj) word = fill();
+        const double huge_mb = (HugePageKilobytes() - huge_before) / 1024.0;
+        vector<uint64_t> candidates(graph.words);
+        for (uint64_t& word : candidates) word = fill();
+
+        // the same vertex sequence in every mode, so the checksums must agree
+        const Measurement probe = Measure(counter, [&]()
+        {
+            Xoshiro256pp gen(options.seed);
+            uint64_t sum = 0;
+            uint64_t bit = 0;
+            for (int64_t i = 0; i < ops; ++i)
+            {
+                // each address waits for the previous bit, so page walks cannot overlap
+                const uint64_t r = gen() + bit;
+                const int v = static_cast<int>((r >> 32) % static_cast<uint64_t>(n));
+                const int u = static_cast<int>((r & 0xFFFFFFFFULL) % static_cast<uint64_t>(n));
+                bit = TestBit(graph.Row(v), u);
+                sum += bit;
+            }
+            return sum;
+        });
+        const int64_t row_ops = max<int64_t>(1, ops / graph.words);
+        const Measurement row = Measure(counter, [&]()
+        {
+            Xoshiro256pp gen(options.seed);
+            uint64_t sum = 0;
+            for (int64_t i = 0; i < row_ops; ++i)
+                sum += AndPopCount(graph.Row(static_cast<int>(gen() % static_cast<uint64_t>(n))), candidates.data(),
+                                   graph.words);
+            return sum;
+        });
+
+        auto print = [&](const char* pattern, const Measurement& m, int64_t count)
+        {
+            cout << left << setw(9) << HugePagesName(mode) << setw(10) << setprecision(1) << huge_mb << setw(9)
+                 << pattern << right << setw(10) << setprecision(3) << m.seconds << setw(10) << setprecision(2)
+                 << m.seconds * 1e9 / count << setw(14);
+            if (m.misses >= 0)
+                cout << setprecision(4) << static_cast<double>(m.misses) / count;
+            else
+                cout << "n/a";
+            cout << "  " << m.checksum << '\n';
+        };
+        print("probe", probe, ops);
+        print("row", row, row_ops);
+    }
+    return 0;
+}